@@ -9,7 +9,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <unistd.h>
 #include <stdarg.h>
 
 #include <libavcodec/avcodec.h>
@@ -17,6 +16,12 @@
 #include <libswresample/swresample.h>
 #include <FAudio.h>
 
+/* Decoded frames go into a ring of reusable buffers. The decoder sleeps
+ * while the ring is full and is woken once FAudio has played it down to
+ * AUDIO_RING_LOW, so it runs a few times a second instead of per frame. */
+#define AUDIO_RING_SIZE 16
+#define AUDIO_RING_LOW 8
+
 /* Internal structures */
 typedef struct {
     AVFormatContext *format_ctx;
@@ -26,6 +31,8 @@ typedef struct {
 } FFmpegContext;
 
 typedef struct {
+    FAudioVoiceCallback callbacks;  /* First, so OnBufferEnd can find us */
+    AudioPlayer *player;
     FAudio *audio;
     FAudioMasteringVoice *mastering_voice;
     FAudioSourceVoice *source_voice;
@@ -35,7 +42,7 @@ typedef struct {
 static void* playback_thread_func(void *arg);
 static int init_ffmpeg_context(FFmpegContext *ctx, const char *filepath);
 static void cleanup_ffmpeg_context(FFmpegContext *ctx);
-static int init_faudio_context(FAudioContext *ctx);
+static int init_faudio_context(FAudioContext *ctx, AudioPlayer *player);
 static void cleanup_faudio_context(FAudioContext *ctx);
 static PlaylistItem* create_playlist_item(const char *filepath);
 static void free_playlist_item(PlaylistItem *item);
@@ -55,6 +62,9 @@ AudioPlayer* audioplayer_create(void) {
     player->volume = 1.0f;  /* Default: 100% volume */
     
     pthread_mutex_init(&player->lock, NULL);
+    pthread_cond_init(&player->state_cond, NULL);
+    pthread_mutex_init(&player->buffer_lock, NULL);
+    pthread_cond_init(&player->buffer_cond, NULL);
     
     return player;
 }
@@ -68,6 +78,9 @@ void audioplayer_destroy(AudioPlayer *player) {
     audioplayer_stop(player);
     audioplayer_clear_playlist(player);
     
+    pthread_cond_destroy(&player->buffer_cond);
+    pthread_mutex_destroy(&player->buffer_lock);
+    pthread_cond_destroy(&player->state_cond);
     pthread_mutex_destroy(&player->lock);
     free(player);
 }
@@ -76,6 +89,14 @@ void audioplayer_destroy(AudioPlayer *player) {
 static void audioplayer_stop_locked(AudioPlayer *player) {
     if (player->state != STATE_STOPPED) {
         player->state = STATE_STOPPED;
+        pthread_cond_broadcast(&player->state_cond);
+        
+        /* Wake the thread if it's waiting for FAudio to free a buffer */
+        pthread_mutex_lock(&player->buffer_lock);
+        player->buffers_abort = true;
+        pthread_cond_broadcast(&player->buffer_cond);
+        pthread_mutex_unlock(&player->buffer_lock);
+        
         pthread_mutex_unlock(&player->lock);
         
         /* Wait for playback thread to finish */
@@ -83,6 +104,10 @@ static void audioplayer_stop_locked(AudioPlayer *player) {
         
         pthread_mutex_lock(&player->lock);
         
+        pthread_mutex_lock(&player->buffer_lock);
+        player->buffers_abort = false;
+        pthread_mutex_unlock(&player->buffer_lock);
+        
         if (player->current_track && !player->playlist_head) {
             /* Free standalone track */
             free_playlist_item(player->current_track);
@@ -189,6 +214,7 @@ int audioplayer_resume(AudioPlayer *player) {
     
     if (player->state == STATE_PAUSED) {
         player->state = STATE_PLAYING;
+        pthread_cond_broadcast(&player->state_cond);
         /* FAudio resume would be called here */
         if (player->faudio_device) {
             FAudioContext *fa_ctx = (FAudioContext*)player->faudio_device;
@@ -607,26 +633,23 @@ static void cleanup_ffmpeg_context(FFmpegContext *ctx) {
     }
 }
 
-/* Callback to free buffer after FAudio is done with it */
+/* Called on FAudio's mixer thread once a ring buffer has been played */
 static void FAUDIOCALL buffer_end_callback(FAudioVoiceCallback *callback, void *pBufferContext) {
-    (void)callback;
-    if (pBufferContext) {
-        free(pBufferContext);
+    AudioPlayer *player = ((FAudioContext*)callback)->player;
+    (void)pBufferContext;
+    
+    pthread_mutex_lock(&player->buffer_lock);
+    player->buffers_queued--;
+    if (player->buffers_queued <= AUDIO_RING_LOW) {
+        pthread_cond_signal(&player->buffer_cond);
     }
+    pthread_mutex_unlock(&player->buffer_lock);
 }
 
-static FAudioVoiceCallback voice_callbacks = {
-    .OnBufferEnd = buffer_end_callback,
-    .OnBufferStart = NULL,
-    .OnLoopEnd = NULL,
-    .OnStreamEnd = NULL,
-    .OnVoiceError = NULL,
-    .OnVoiceProcessingPassEnd = NULL,
-    .OnVoiceProcessingPassStart = NULL
-};
-
-static int init_faudio_context(FAudioContext *ctx) {
+static int init_faudio_context(FAudioContext *ctx, AudioPlayer *player) {
     memset(ctx, 0, sizeof(FAudioContext));
+    ctx->callbacks.OnBufferEnd = buffer_end_callback;
+    ctx->player = player;
     
     /* Create FAudio instance */
     if (FAudioCreate(&ctx->audio, 0, FAUDIO_DEFAULT_PROCESSOR) != 0) {
@@ -652,7 +675,7 @@ static int init_faudio_context(FAudioContext *ctx) {
     };
     
     if (FAudio_CreateSourceVoice(ctx->audio, &ctx->source_voice, &waveformat,
-        0, FAUDIO_DEFAULT_FREQ_RATIO, &voice_callbacks, NULL, NULL) != 0) {
+        0, FAUDIO_DEFAULT_FREQ_RATIO, &ctx->callbacks, NULL, NULL) != 0) {
         FAudioVoice_DestroyVoice(ctx->mastering_voice);
         FAudio_Release(ctx->audio);
         return -1;
@@ -699,7 +722,11 @@ static void* playback_thread_func(void *arg) {
     }
     fprintf(stderr, "[AudioPlayer] FFmpeg initialized successfully\n");
     
-    if (init_faudio_context(&faudio_ctx) < 0) {
+    pthread_mutex_lock(&player->buffer_lock);
+    player->buffers_queued = 0;
+    pthread_mutex_unlock(&player->buffer_lock);
+    
+    if (init_faudio_context(&faudio_ctx, player) < 0) {
         fprintf(stderr, "[AudioPlayer] Failed to initialize FAudio context\n");
         cleanup_ffmpeg_context(&ffmpeg_ctx);
         pthread_mutex_lock(&player->lock);
@@ -722,10 +749,16 @@ static void* playback_thread_func(void *arg) {
     /* Decode and play loop */
     AVPacket *packet = av_packet_alloc();
     AVFrame *frame = av_frame_alloc();
-    uint8_t *audio_buffer = malloc(192000); /* 1 second buffer */
+    uint8_t *ring[AUDIO_RING_SIZE] = { NULL };
+    int ring_capacity[AUDIO_RING_SIZE] = { 0 };
+    int ring_next = 0;
     
     while (av_read_frame(ffmpeg_ctx.format_ctx, packet) >= 0) {
+        /* Sleep while paused, resume and stop wake us up */
         pthread_mutex_lock(&player->lock);
+        while (player->state == STATE_PAUSED) {
+            pthread_cond_wait(&player->state_cond, &player->lock);
+        }
         PlayerState state = player->state;
         pthread_mutex_unlock(&player->lock);
         
@@ -733,51 +766,64 @@ static void* playback_thread_func(void *arg) {
             break;
         }
         
-        /* Wait while paused */
-        while (state == STATE_PAUSED) {
-            usleep(10000);
-            pthread_mutex_lock(&player->lock);
-            state = player->state;
-            pthread_mutex_unlock(&player->lock);
-        }
-        
         if (packet->stream_index == ffmpeg_ctx.audio_stream_index) {
             if (avcodec_send_packet(ffmpeg_ctx.codec_ctx, packet) == 0) {
                 while (avcodec_receive_frame(ffmpeg_ctx.codec_ctx, frame) == 0) {
-                    /* Resample audio */
+                    /* Wait until FAudio has a ring buffer free again */
+                    pthread_mutex_lock(&player->buffer_lock);
+                    while (player->buffers_queued >= AUDIO_RING_SIZE && !player->buffers_abort) {
+                        pthread_cond_wait(&player->buffer_cond, &player->buffer_lock);
+                    }
+                    bool aborted = player->buffers_abort;
+                    pthread_mutex_unlock(&player->buffer_lock);
+                    
+                    if (aborted) {
+                        break;
+                    }
+                    
+                    /* Buffers are played in order, so the next slot is the
+                     * oldest one and FAudio is done with it */
+                    int out_max = swr_get_out_samples(ffmpeg_ctx.swr_ctx, frame->nb_samples);
+                    if (out_max > ring_capacity[ring_next]) {
+                        free(ring[ring_next]);
+                        ring[ring_next] = malloc(out_max * 4);
+                        ring_capacity[ring_next] = ring[ring_next] ? out_max : 0;
+                    }
+                    if (!ring[ring_next]) {
+                        break;
+                    }
+                    
+                    /* Resample audio straight into the ring buffer */
                     int out_samples = swr_convert(ffmpeg_ctx.swr_ctx,
-                        &audio_buffer, frame->nb_samples,
+                        &ring[ring_next], ring_capacity[ring_next],
                         (const uint8_t**)frame->data, frame->nb_samples);
                     
                     if (out_samples > 0) {
                         size_t buffer_size = out_samples * 4; /* 2 channels * 16-bit */
                         
-                        /* Copy buffer data - FAudio will keep the pointer */
-                        uint8_t *buffer_copy = malloc(buffer_size);
-                        memcpy(buffer_copy, audio_buffer, buffer_size);
-                        
                         /* Submit audio buffer to FAudio */
                         FAudioBuffer buffer = {
                             .AudioBytes = buffer_size,
-                            .pAudioData = buffer_copy,
+                            .pAudioData = ring[ring_next],
                             .PlayBegin = 0,
                             .PlayLength = 0,
                             .LoopBegin = 0,
                             .LoopLength = 0,
                             .LoopCount = 0,
-                            .pContext = buffer_copy  /* Store pointer so we can free it */
+                            .pContext = NULL
                         };
                         
-                        FAudioSourceVoice_SubmitSourceBuffer(faudio_ctx.source_voice, &buffer, NULL);
+                        pthread_mutex_lock(&player->buffer_lock);
+                        player->buffers_queued++;
+                        pthread_mutex_unlock(&player->buffer_lock);
                         
-                        /* Wait if too many buffers are queued */
-                        FAudioVoiceState voice_state;
-                        do {
-                            FAudioSourceVoice_GetState(faudio_ctx.source_voice, &voice_state, 0);
-                            if (voice_state.BuffersQueued > 4) {
-                                usleep(5000);
-                            }
-                        } while (voice_state.BuffersQueued > 4);
+                        if (FAudioSourceVoice_SubmitSourceBuffer(faudio_ctx.source_voice, &buffer, NULL) != 0) {
+                            pthread_mutex_lock(&player->buffer_lock);
+                            player->buffers_queued--;
+                            pthread_mutex_unlock(&player->buffer_lock);
+                        } else {
+                            ring_next = (ring_next + 1) % AUDIO_RING_SIZE;
+                        }
                     }
                 }
             }
@@ -787,22 +833,24 @@ static void* playback_thread_func(void *arg) {
     }
     
     /* Wait for remaining buffers to play */
-    FAudioVoiceState voice_state;
-    do {
-        FAudioSourceVoice_GetState(faudio_ctx.source_voice, &voice_state, 0);
-        if (voice_state.BuffersQueued > 0) {
-            usleep(10000);
-        }
-    } while (voice_state.BuffersQueued > 0);
+    pthread_mutex_lock(&player->buffer_lock);
+    while (player->buffers_queued > 0 && !player->buffers_abort) {
+        pthread_cond_wait(&player->buffer_cond, &player->buffer_lock);
+    }
+    pthread_mutex_unlock(&player->buffer_lock);
     
     /* Cleanup */
-    free(audio_buffer);
     av_frame_free(&frame);
     av_packet_free(&packet);
     
     cleanup_faudio_context(&faudio_ctx);
     cleanup_ffmpeg_context(&ffmpeg_ctx);
     
+    /* The voice is gone, nothing points into the ring any more */
+    for (int i = 0; i < AUDIO_RING_SIZE; i++) {
+        free(ring[i]);
+    }
+    
     pthread_mutex_lock(&player->lock);
     player->ffmpeg_ctx = NULL;
     player->faudio_device = NULL;
@@ -50,6 +50,14 @@ struct AudioPlayer {
     
     pthread_t playback_thread;
     pthread_mutex_t lock;
+    pthread_cond_t state_cond;     /* Signalled on resume and stop */
+    
+    /* Buffers handed to FAudio; separate lock since FAudio's mixer thread
+     * takes it from OnBufferEnd */
+    pthread_mutex_t buffer_lock;
+    pthread_cond_t buffer_cond;
+    int buffers_queued;
+    bool buffers_abort;
     
     void *ffmpeg_ctx;      /* FFmpeg context */
     void *faudio_device;   /* FAudio device */
@@ -92,8 +92,14 @@ static const signed char fish_unbase64[256] = {
 static OSSL_PROVIDER *legacy_provider;
 static OSSL_PROVIDER *default_provider;
 static OSSL_LIB_CTX *ossl_ctx;
+static EVP_CIPHER *cipher_ecb;
+static EVP_CIPHER *cipher_cbc;
 #endif
 
+/* Cipher contexts with the key schedule done, by mode and key */
+#define MAX_CIPHER_CONTEXTS 64
+static GHashTable *cipher_contexts;
+
 int fish_init(void)
 {
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
@@ -118,7 +124,19 @@ int fish_init(void)
 
 void fish_deinit(void)
 {
+    g_clear_pointer(&cipher_contexts, g_hash_table_destroy);
+
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    if (cipher_ecb) {
+        EVP_CIPHER_free(cipher_ecb);
+        cipher_ecb = NULL;
+    }
+
+    if (cipher_cbc) {
+        EVP_CIPHER_free(cipher_cbc);
+        cipher_cbc = NULL;
+    }
+
     if (legacy_provider) {
         OSSL_PROVIDER_unload(legacy_provider);
         legacy_provider = NULL;
@@ -225,6 +243,92 @@ char *fish_base64_decode(const char *message, size_t *final_len) {
     return bytes;
 }
 
+/**
+ * Returns the Blowfish cipher for a mode, fetched once for the plugin lifetime
+ *
+ * @param [in] mode  EVP_CIPH_ECB_MODE or EVP_CIPH_CBC_MODE
+ * @return The cipher or NULL for an unknown mode
+ */
+static const EVP_CIPHER *fish_get_cipher(int mode) {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    if (mode == EVP_CIPH_CBC_MODE) {
+        if (!cipher_cbc)
+            cipher_cbc = EVP_CIPHER_fetch(ossl_ctx, "BF-CBC", NULL);
+        return cipher_cbc;
+    } else if (mode == EVP_CIPH_ECB_MODE) {
+        if (!cipher_ecb)
+            cipher_ecb = EVP_CIPHER_fetch(ossl_ctx, "BF-ECB", NULL);
+        return cipher_ecb;
+    }
+#else
+    if (mode == EVP_CIPH_CBC_MODE)
+        return EVP_bf_cbc();
+    else if (mode == EVP_CIPH_ECB_MODE)
+        return EVP_bf_ecb();
+#endif
+    return NULL;
+}
+
+/**
+ * Returns a cipher context set up with a key, the Blowfish key schedule is
+ * only computed the first time a key is used. Each use must set the
+ * direction and IV again with EVP_CipherInit_ex.
+ *
+ * @param [in] key     Bytes of key
+ * @param [in] keylen  Size of key
+ * @param [in] mode    EVP_CIPH_ECB_MODE or EVP_CIPH_CBC_MODE
+ * @return The context (owned by the cache) or NULL if any error occurred
+ */
+static EVP_CIPHER_CTX *fish_get_context(const char *key, size_t keylen, int mode) {
+    EVP_CIPHER_CTX *ctx;
+    const EVP_CIPHER *cipher;
+    GBytes *id;
+    char *id_data;
+
+    /* The mode and key together identify a context */
+    id_data = g_malloc(keylen + 1);
+    id_data[0] = (char) mode;
+    memcpy(id_data + 1, key, keylen);
+    id = g_bytes_new_take(id_data, keylen + 1);
+
+    if (!cipher_contexts)
+        cipher_contexts = g_hash_table_new_full(g_bytes_hash, g_bytes_equal,
+                                                (GDestroyNotify) g_bytes_unref,
+                                                (GDestroyNotify) EVP_CIPHER_CTX_free);
+
+    ctx = g_hash_table_lookup(cipher_contexts, id);
+    if (ctx) {
+        g_bytes_unref(id);
+        return ctx;
+    }
+
+    cipher = fish_get_cipher(mode);
+    if (!cipher || !(ctx = EVP_CIPHER_CTX_new())) {
+        g_bytes_unref(id);
+        return NULL;
+    }
+
+    /* Initialise the cipher operation only with mode, set custom key length
+     * and then the key itself */
+    if (!EVP_CipherInit_ex(ctx, cipher, NULL, NULL, NULL, 1) ||
+        !EVP_CIPHER_CTX_set_key_length(ctx, keylen) ||
+        !EVP_CipherInit_ex(ctx, NULL, NULL, (const unsigned char *) key, NULL, 1)) {
+        EVP_CIPHER_CTX_free(ctx);
+        g_bytes_unref(id);
+        return NULL;
+    }
+
+    /* We will manage this */
+    EVP_CIPHER_CTX_set_padding(ctx, 0);
+
+    /* Keys come and go with targets, don't let old ones pile up */
+    if (g_hash_table_size(cipher_contexts) >= MAX_CIPHER_CONTEXTS)
+        g_hash_table_remove_all(cipher_contexts);
+
+    g_hash_table_insert(cipher_contexts, id, ctx);
+    return ctx;
+}
+
 /**
  * Encrypt or decrypt data with Blowfish cipher, support binary data.
  *
@@ -249,7 +353,6 @@ char *fish_base64_decode(const char *message, size_t *final_len) {
  */
 char *fish_cipher(const char *plaintext, size_t plaintext_len, const char *key, size_t keylen, int encode, int mode, size_t *ciphertext_len) {
     EVP_CIPHER_CTX *ctx;
-    EVP_CIPHER *cipher = NULL;
     int bytes_written = 0;
     unsigned char *ciphertext = NULL;
     unsigned char *iv_ciphertext = NULL;
@@ -276,20 +379,6 @@ char *fish_cipher(const char *plaintext, size_t plaintext_len, const char *key,
             plaintext += 8;
             plaintext_len -= 8;
         }
-
-#if OPENSSL_VERSION_NUMBER >= 0x30000000L
-        cipher = EVP_CIPHER_fetch(ossl_ctx, "BF-CBC", NULL);
-#else
-        cipher = (EVP_CIPHER *) EVP_bf_cbc();
-#endif
-
-    } else if (mode == EVP_CIPH_ECB_MODE) {
-
-#if OPENSSL_VERSION_NUMBER >= 0x30000000L
-        cipher = EVP_CIPHER_fetch(ossl_ctx, "BF-ECB", NULL);
-#else
-        cipher = (EVP_CIPHER *) EVP_bf_ecb();
-#endif
     }
 
     /* Zero Padding */
@@ -300,40 +389,26 @@ char *fish_cipher(const char *plaintext, size_t plaintext_len, const char *key,
     ciphertext = (unsigned char *) g_malloc0(block_size);
     memcpy(ciphertext, plaintext, plaintext_len);
 
-    /* Create and initialise the context */
-    if (!(ctx = EVP_CIPHER_CTX_new()))
-        return NULL;
+    /* Get the context for this key, keeping its key schedule */
+    if (!(ctx = fish_get_context(key, keylen, mode)))
+        goto fail;
 
-    /* Initialise the cipher operation only with mode */
-    if (!EVP_CipherInit_ex(ctx, cipher, NULL, NULL, NULL, encode))
-        return NULL;
-
-    /* Set custom key length */
-    if (!EVP_CIPHER_CTX_set_key_length(ctx, keylen))
-        return NULL;
-
-    /* Finish the initiation the cipher operation */
-    if (1 != EVP_CipherInit_ex(ctx, NULL, NULL, (const unsigned char *) key, iv, encode))
-        return NULL;
-
-    /* We will manage this */
-    EVP_CIPHER_CTX_set_padding(ctx, 0);
+    /* Start the cipher operation with this direction and IV */
+    if (1 != EVP_CipherInit_ex(ctx, NULL, NULL, NULL, iv, encode))
+        goto fail;
 
     /* Do cipher operation */
     if (1 != EVP_CipherUpdate(ctx, ciphertext, &bytes_written, ciphertext, block_size))
-        return NULL;
+        goto fail;
 
     *ciphertext_len = bytes_written;
 
     /* Finalise the cipher. Further ciphertext bytes may be written at this stage */
     if (1 != EVP_CipherFinal_ex(ctx, ciphertext + bytes_written, &bytes_written))
-        return NULL;
+        goto fail;
 
     *ciphertext_len += bytes_written;
 
-    /* Clean up */
-    EVP_CIPHER_CTX_free(ctx);
-
 
     if (mode == EVP_CIPH_CBC_MODE && encode == 1) {
         /* Join IV + DATA */
@@ -350,6 +425,13 @@ char *fish_cipher(const char *plaintext, size_t plaintext_len, const char *key,
     } else {
         return (char *) ciphertext;
     }
+
+fail:
+    *ciphertext_len = 0;
+    g_free(ciphertext);
+    if (mode == EVP_CIPH_CBC_MODE && encode == 1)
+        g_free(iv);
+    return NULL;
 }
 
 /**
@@ -529,6 +611,7 @@ GSList *fish_encrypt_for_nick(const char *nick, const char *data, enum fish_mode
         data_chunk += chunks_len;
     }
 
+    g_free(key);
     return encrypted_list;
 }
 
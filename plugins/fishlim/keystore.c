@@ -25,6 +25,7 @@
 #include "config.h"
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "irc.h"
@@ -35,20 +36,86 @@
 
 static char *keystore_password = NULL;
 
+/* The parsed key store file, reparsed only when it changes on disk */
+static GKeyFile *keystore_file = NULL;
+static gint64 keystore_mtime = 0;
+static gint64 keystore_size = -1;
+
+/* Decrypted keys by escaped nick, including nicks that have no key */
+typedef struct {
+    char *key;
+    enum fish_mode mode;
+} cached_key;
+
+static GHashTable *keystore_keys = NULL;
+
+
+static void cached_key_free(cached_key *entry) {
+    g_free(entry->key);
+    g_free(entry);
+}
+
+static void keystore_stat(const char *filename, gint64 *mtime, gint64 *size) {
+    GStatBuf st;
+
+    if (g_stat(filename, &st) == 0) {
+        *mtime = st.st_mtime;
+        *size = st.st_size;
+    } else {
+        *mtime = 0;
+        *size = -1;
+    }
+}
+
+/**
+ * Forgets all decrypted keys, they are looked up again on next use.
+ */
+static void keystore_forget_keys(void) {
+    if (keystore_keys)
+        g_hash_table_remove_all(keystore_keys);
+}
+
+/**
+ * Throws away the parsed key store file and the decrypted keys, so that
+ * the next access loads them from disk again.
+ */
+static void keystore_drop_cache(void) {
+    keystore_forget_keys();
+    g_clear_pointer(&keystore_file, g_key_file_free);
+    keystore_mtime = 0;
+    keystore_size = -1;
+}
 
 /**
  * Opens the key store file: ~/.config/pchat/addon_fishlim.conf
+ *
+ * The file is kept parsed in memory and only loaded again when its
+ * modification time or size changes. The returned key file is owned by
+ * the key store and must not be freed.
  */
 static GKeyFile *getConfigFile(void) {
     gchar *filename = get_config_filename();
-    
-    GKeyFile *keyfile = g_key_file_new();
-    g_key_file_load_from_file(keyfile, filename,
+    gint64 mtime, size;
+
+    keystore_stat(filename, &mtime, &size);
+    if (keystore_file && mtime == keystore_mtime && size == keystore_size) {
+        g_free(filename);
+        return keystore_file;
+    }
+
+    if (keystore_file)
+        g_key_file_free(keystore_file);
+
+    keystore_file = g_key_file_new();
+    g_key_file_load_from_file(keystore_file, filename,
                               G_KEY_FILE_KEEP_COMMENTS |
                               G_KEY_FILE_KEEP_TRANSLATIONS, NULL);
-    
+    keystore_mtime = mtime;
+    keystore_size = size;
+    keystore_forget_keys();
+
     g_free(filename);
-    return keyfile;
+    return keystore_file;
 }
 
 
@@ -101,11 +168,9 @@ static gchar *get_nick_value(GKeyFile *keyfile, const char *nick, const char *it
 
 
 /**
- * Extracts a key from the key store file.
+ * Reads and decrypts a key from the key store file.
  */
-char *keystore_get_key(const char *nick, enum fish_mode *mode) {
-    GKeyFile *keyfile;
-    char *escaped_nick;
+static char *load_key(GKeyFile *keyfile, const char *escaped_nick, enum fish_mode *mode) {
     gchar *value, *key_mode;
     int encrypted_mode;
     char *password;
@@ -113,12 +178,8 @@ char *keystore_get_key(const char *nick, enum fish_mode *mode) {
     char *decrypted;
 
     /* Get the key */
-    keyfile = getConfigFile();
-    escaped_nick = escape_nickname(nick);
     value = get_nick_value(keyfile, escaped_nick, "key");
     key_mode = get_nick_value(keyfile, escaped_nick, "mode");
-    g_key_file_free(keyfile);
-    g_free(escaped_nick);
 
     /* Determine cipher mode */
     *mode = FISH_ECB_MODE;
@@ -155,6 +216,31 @@ char *keystore_get_key(const char *nick, enum fish_mode *mode) {
     }
 }
 
+/**
+ * Extracts a key from the key store.
+ */
+char *keystore_get_key(const char *nick, enum fish_mode *mode) {
+    GKeyFile *keyfile = getConfigFile();
+    char *escaped_nick = escape_nickname(nick);
+    cached_key *entry;
+
+    if (!keystore_keys)
+        keystore_keys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                              (GDestroyNotify) cached_key_free);
+
+    entry = g_hash_table_lookup(keystore_keys, escaped_nick);
+    if (!entry) {
+        entry = g_new0(cached_key, 1);
+        entry->key = load_key(keyfile, escaped_nick, &entry->mode);
+        g_hash_table_insert(keystore_keys, escaped_nick, entry);
+    } else {
+        g_free(escaped_nick);
+    }
+
+    *mode = entry->mode;
+    return g_strdup(entry->key);
+}
+
 /**
  * Deletes a nick and the associated key in the key store file.
  */
@@ -209,6 +295,16 @@ G_GNUC_BEGIN_IGNORE_DEPRECATIONS /* Hide false positive */
     ok = g_key_file_save_to_file (keyfile, filename, NULL);
 G_GNUC_END_IGNORE_DEPRECATIONS
 #endif
+
+    /* Our own write shouldn't make the next lookup parse the file again,
+     * but if it failed the in-memory copy no longer matches the disk */
+    if (ok) {
+        keystore_stat(filename, &keystore_mtime, &keystore_size);
+        keystore_forget_keys();
+    } else {
+        keystore_drop_cache();
+    }
+
     g_free (filename);
 
     return ok;
@@ -220,41 +316,41 @@ G_GNUC_END_IGNORE_DEPRECATIONS
 gboolean keystore_store_key(const char *nick, const char *key, enum fish_mode mode) {
     const char *password;
     char *encrypted;
-    char *wrapped;
+    char *value;
     gboolean ok = FALSE;
-    GKeyFile *keyfile = getConfigFile();
-    char *escaped_nick = escape_nickname(nick);
+    GKeyFile *keyfile;
+    char *escaped_nick;
 
-    /* Remove old key */
-    delete_nick(keyfile, escaped_nick);
-    
-    /* Add new key */
+    /* Build the value first, the cached key file must not be touched
+     * if this fails */
     password = get_keystore_password();
     if (password) {
         /* Encrypt the password */
         encrypted = fish_encrypt(password, strlen(password), key, strlen(key), FISH_CBC_MODE);
-        if (!encrypted) goto end;
+        if (!encrypted) return FALSE;
         
         /* Prepend "+OK " */
-        wrapped = g_strconcat("+OK *", encrypted, NULL);
+        value = g_strconcat("+OK *", encrypted, NULL);
         g_free(encrypted);
-        
-        /* Store encrypted in file */
-        g_key_file_set_string(keyfile, escaped_nick, "key", wrapped);
-        g_free(wrapped);
     } else {
         /* Store unencrypted in file */
-        g_key_file_set_string(keyfile, escaped_nick, "key", key);
+        value = g_strdup(key);
     }
 
-    /* Store cipher mode */
+    keyfile = getConfigFile();
+    escaped_nick = escape_nickname(nick);
+
+    /* Remove old key */
+    delete_nick(keyfile, escaped_nick);
+    
+    /* Add new key and cipher mode */
+    g_key_file_set_string(keyfile, escaped_nick, "key", value);
     g_key_file_set_integer(keyfile, escaped_nick, "mode", mode);
     
     /* Save key store file */
     ok = save_keystore(keyfile);
     
-  end:
-    g_key_file_free(keyfile);
+    g_free(value);
     g_free(escaped_nick);
     return ok;
 }
@@ -269,10 +365,17 @@ gboolean keystore_delete_nick(const char *nick) {
     /* Delete entry */
     gboolean ok = delete_nick(keyfile, escaped_nick);
     
-    /* Save */
+    /* Save, a failed save drops the cache */
     if (ok) save_keystore(keyfile);
     
-    g_key_file_free(keyfile);
     g_free(escaped_nick);
     return ok;
 }
+
+/**
+ * Frees the in-memory copy of the key store.
+ */
+void keystore_deinit(void) {
+    keystore_drop_cache();
+    g_clear_pointer(&keystore_keys, g_hash_table_destroy);
+}
@@ -844,6 +844,7 @@ int pchat_plugin_deinit(void) {
     g_clear_pointer(&pending_exchanges, g_hash_table_destroy);
     dh1080_deinit();
     fish_deinit();
+    keystore_deinit();
 
     pchat_printf(ph, "%s plugin unloaded\n", plugin_name);
     return 1;
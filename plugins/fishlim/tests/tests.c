@@ -264,6 +264,37 @@ test_foreach_utf8_data_chunks(void)
     g_rand_free (rand);
 }
 
+/**
+ * Measure how many messages per second can be encrypted and decrypted again
+ * with a single key, run with -m perf
+ */
+static void
+test_perf_messages(gconstpointer data)
+{
+    enum fish_mode mode = GPOINTER_TO_INT(data);
+    char *b64 = NULL;
+    char *de = NULL;
+    char key[57];
+    char message[301];
+    int i, count = 20000;
+    double elapsed;
+
+    random_string(key, 56);
+    random_string(message, 300);
+
+    g_test_timer_start();
+    for (i = 0; i < count; ++i) {
+        b64 = fish_encrypt(key, 56, message, 300, mode);
+        de = fish_decrypt_str(key, 56, b64, mode);
+        g_free(b64);
+        g_free(de);
+    }
+    elapsed = g_test_timer_elapsed();
+
+    g_test_maximized_result(count / elapsed, "%s: %.0f messages/s",
+                            mode == FISH_CBC_MODE ? "CBC" : "ECB", count / elapsed);
+}
+
 int
 main(int argc, char *argv[]) {
 
@@ -278,6 +309,11 @@ main(int argc, char *argv[]) {
     g_test_add_func("/fishlim/max_text_command_len", test_max_text_command_len);
     g_test_add_func("/fishlim/foreach_utf8_data_chunks", test_foreach_utf8_data_chunks);
 
+    if (g_test_perf()) {
+        g_test_add_data_func("/fishlim/perf/ecb", GINT_TO_POINTER(FISH_ECB_MODE), test_perf_messages);
+        g_test_add_data_func("/fishlim/perf/cbc", GINT_TO_POINTER(FISH_CBC_MODE), test_perf_messages);
+    }
+
     fish_init();
     int ret = g_test_run();
     fish_deinit();
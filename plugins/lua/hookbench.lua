@@ -0,0 +1,30 @@
+-- Hook load for timing the Lua plugin with pchat-replay.
+--
+-- It hooks every PRIVMSG and "Channel Message" and reads what a typical
+-- trigger script reads, so the replay numbers show what the hooks cost
+-- per line. HOOKBENCH_LAZY=1 registers them with the lazy flag, compare:
+--
+--   pchat-replay -d $(mktemp -d) --load=lua.so --load=hookbench.lua --synthetic=100000
+--   HOOKBENCH_LAZY=1 pchat-replay -d $(mktemp -d) --load=lua.so --load=hookbench.lua --synthetic=100000
+--
+-- Without --synthetic, --emit=N times "Channel Message" on its own.
+
+pchat.register("hookbench", "1.0", "Lua hook load for pchat-replay")
+
+local lazy = (os.getenv("HOOKBENCH_LAZY") or "0") ~= "0"
+
+pchat.hook_server("PRIVMSG", function (word, word_eol)
+	if word_eol[4]:sub(1, 2) == ":!" then
+		return pchat.EAT_PLUGIN
+	end
+	return pchat.EAT_NONE
+end, pchat.PRI_NORM, lazy)
+
+pchat.hook_print("Channel Message", function (word)
+	if word[1] == "nobody" then
+		return pchat.EAT_PLUGIN
+	end
+	return pchat.EAT_NONE
+end, pchat.PRI_NORM, lazy)
+
+print("hookbench: " .. (lazy and "lazy" or "eager") .. " hooks")
@@ -66,9 +66,21 @@ typedef struct
 	pchat_hook *hook;
 	lua_State *state;
 	int ref;
+	int lazy;
 }
 hook_info;
 
+/* word/word_eol handed to a lazy hook: strings are only pushed when the
+ * script indexes them, and the proxy is invalidated once the callback
+ * returns since the arrays belong to the caller */
+typedef struct
+{
+	char **word;
+	int len;
+	int valid;
+}
+word_proxy;
+
 typedef struct
 {
 	char *name;
@@ -266,39 +278,161 @@ static int unregister_hook(hook_info *hook)
 	return 0;
 }
 
-static int api_command_closure(char *word[], char *word_eol[], void *udata)
+static int word_array_len(char *word[], char *word_eol[])
 {
-	int base, i, ret;
-	hook_info *info = udata;
-	lua_State *L = info->state;
-	script_info *script = get_info(L);
+	int i;
 
-	lua_rawgeti(L, LUA_REGISTRYINDEX, script->traceback);
-	base = lua_gettop(L);
-	lua_rawgeti(L, LUA_REGISTRYINDEX, info->ref);
-	lua_newtable(L);
-	for(i = 1; i < WORD_ARRAY_LEN && *word_eol[i]; i++)
+	if(word_eol)
+	{
+		for(i = 1; i < WORD_ARRAY_LEN && *word_eol[i]; i++);
+		return i - 1;
+	}
+	for(i = 31; i >= 1; i--)
+	{
+		if(*word[i])
+			break;
+	}
+	return i;
+}
+
+static void push_word_table(lua_State *L, char *word[], int len)
+{
+	int i;
+
+	lua_createtable(L, len, 0);
+	for(i = 1; i <= len; i++)
 	{
 		lua_pushstring(L, word[i]);
 		lua_rawseti(L, -2, i);
 	}
-	lua_newtable(L);
-	for(i = 1; i < WORD_ARRAY_LEN && *word_eol[i]; i++)
+}
+
+static word_proxy *push_word_proxy(lua_State *L, char *word[], int len)
+{
+	word_proxy *proxy = lua_newuserdata(L, sizeof(word_proxy));
+	proxy->word = word;
+	proxy->len = len;
+	proxy->valid = 1;
+	luaL_newmetatable(L, "words");
+	lua_setmetatable(L, -2);
+	return proxy;
+}
+
+static word_proxy *check_word_proxy(lua_State *L, int index)
+{
+	word_proxy *proxy = luaL_checkudata(L, index, "words");
+	if(!proxy->valid)
+		luaL_error(L, "word array used after its hook returned");
+	return proxy;
+}
+
+/* Pushes the arguments for a word/word_eol hook. Lazy hooks get proxies,
+ * which are also left below the function so they stay alive for
+ * invalidate_words() even if the script drops its references. */
+static void push_words(lua_State *L, hook_info *info, char *word[], char *word_eol[], word_proxy **proxies)
+{
+	int len = word_array_len(word, word_eol);
+
+	proxies[0] = proxies[1] = NULL;
+	if(info->lazy)
 	{
-		lua_pushstring(L, word_eol[i]);
-		lua_rawseti(L, -2, i);
+		proxies[0] = push_word_proxy(L, word, len);
+		if(word_eol)
+			proxies[1] = push_word_proxy(L, word_eol, len);
+		lua_rawgeti(L, LUA_REGISTRYINDEX, info->ref);
+		lua_pushvalue(L, word_eol ? -3 : -2);
+		if(word_eol)
+			lua_pushvalue(L, -3);
+		return;
 	}
+	lua_rawgeti(L, LUA_REGISTRYINDEX, info->ref);
+	push_word_table(L, word, len);
+	if(word_eol)
+		push_word_table(L, word_eol, len);
+}
+
+static void invalidate_words(lua_State *L, word_proxy **proxies)
+{
+	int i;
+
+	for(i = 0; i < 2 && proxies[i]; i++)
+		proxies[i]->valid = 0;
+	lua_pop(L, i);
+}
+
+static int api_words_meta_index(lua_State *L)
+{
+	word_proxy *proxy = check_word_proxy(L, 1);
+	int i;
+
+	if(lua_type(L, 2) != LUA_TNUMBER)
+		return 0;
+	i = lua_tointeger(L, 2);
+	if(i < 1 || i > proxy->len)
+		return 0;
+	lua_pushstring(L, proxy->word[i]);
+	return 1;
+}
+
+static int api_words_meta_newindex(lua_State *L)
+{
+	return luaL_error(L, "word array is read-only");
+}
+
+static int api_words_meta_len(lua_State *L)
+{
+	word_proxy *proxy = check_word_proxy(L, 1);
+	lua_pushinteger(L, proxy->len);
+	return 1;
+}
+
+static int api_words_meta_next(lua_State *L)
+{
+	word_proxy *proxy = check_word_proxy(L, 1);
+	int i = luaL_optinteger(L, 2, 0) + 1;
+
+	if(i > proxy->len)
+		return 0;
+	lua_pushinteger(L, i);
+	lua_pushstring(L, proxy->word[i]);
+	return 2;
+}
+
+static int api_words_meta_ipairs(lua_State *L)
+{
+	check_word_proxy(L, 1);
+	lua_pushcfunction(L, api_words_meta_next);
+	lua_pushvalue(L, 1);
+	lua_pushinteger(L, 0);
+	return 3;
+}
+
+static int api_command_closure(char *word[], char *word_eol[], void *udata)
+{
+	int base, ret;
+	hook_info *info = udata;
+	lua_State *L = info->state;
+	script_info *script = get_info(L);
+	word_proxy *proxies[2];
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, script->traceback);
+	base = lua_gettop(L);
+	push_words(L, info, word, word_eol, proxies);
 	script->status |= STATUS_ACTIVE;
 	if(lua_pcall(L, 2, 1, base))
 	{
 		char const *error = lua_tostring(L, -1);
-		lua_pop(L, 2);
+		lua_pop(L, 1);
+		invalidate_words(L, proxies);
+		lua_pop(L, 1);
 		pchat_printf(ph, "Lua error in command hook: %s", error ? error : "(non-string error)");
 		check_deferred(script);
 		return PCHAT_EAT_NONE;
 	}
 	ret = lua_tointeger(L, -1);
-	lua_pop(L, 2);
+	lua_pop(L, 1);
+	invalidate_words(L, proxies);
+	lua_pop(L, 1);
 	check_deferred(script);
 	return ret;
 }
@@ -317,6 +451,7 @@ static int api_pchat_hook_command(lua_State *L)
 	info = g_new(hook_info, 1);
 	info->state = L;
 	info->ref = ref;
+	info->lazy = lua_toboolean(L, 5);
 	info->hook = pchat_hook_command(ph, command, pri, api_command_closure, help, info);
 	u = lua_newuserdata(L, sizeof(hook_info *));
 	*u = info;
@@ -331,34 +466,27 @@ static int api_print_closure(char *word[], void *udata)
 	hook_info *info = udata;
 	lua_State *L = info->state;
 	script_info *script = get_info(L);
-	int i, j, base, ret;
+	int base, ret;
+	word_proxy *proxies[2];
 
 	lua_rawgeti(L, LUA_REGISTRYINDEX, script->traceback);
 	base = lua_gettop(L);
-	lua_rawgeti(L, LUA_REGISTRYINDEX, info->ref);
-
-	for(j = 31; j >= 1; j--)
-	{
-		if(*word[j])
-			break;
-	}
-	lua_newtable(L);
-	for(i = 1; i <= j; i++)
-	{
-		lua_pushstring(L, word[i]);
-		lua_rawseti(L, -2, i);
-	}
+	push_words(L, info, word, NULL, proxies);
 	script->status |= STATUS_ACTIVE;
 	if(lua_pcall(L, 1, 1, base))
 	{
 		char const *error = lua_tostring(L, -1);
-		lua_pop(L, 2);
+		lua_pop(L, 1);
+		invalidate_words(L, proxies);
+		lua_pop(L, 1);
 		pchat_printf(ph, "Lua error in print hook: %s", error ? error : "(non-string error)");
 		check_deferred(script);
 		return PCHAT_EAT_NONE;
 	}
 	ret = lua_tointeger(L, -1);
-	lua_pop(L, 2);
+	lua_pop(L, 1);
+	invalidate_words(L, proxies);
+	lua_pop(L, 1);
 	check_deferred(script);
 	return ret;
 }
@@ -375,6 +503,7 @@ static int api_pchat_hook_print(lua_State *L)
 	info = g_new(hook_info, 1);
 	info->state = L;
 	info->ref = ref;
+	info->lazy = lua_toboolean(L, 4);
 	info->hook = pchat_hook_print(ph, event, pri, api_print_closure, info);
 	u = lua_newuserdata(L, sizeof(hook_info *));
 	*u = info;
@@ -396,23 +525,13 @@ static int api_print_attrs_closure(char *word[], pchat_event_attrs *attrs, void
 	hook_info *info = udata;
 	lua_State *L = info->state;
 	script_info *script = get_info(L);
-	int base, i, j, ret;
+	int base, ret;
 	pchat_event_attrs **u;
+	word_proxy *proxies[2];
 
 	lua_rawgeti(L, LUA_REGISTRYINDEX, script->traceback);
 	base = lua_gettop(L);
-	lua_rawgeti(L, LUA_REGISTRYINDEX, info->ref);
-	for(j = 31; j >= 1; j--)
-	{
-		if(*word[j])
-			break;
-	}
-	lua_newtable(L);
-	for(i = 1; i <= j; i++)
-	{
-		lua_pushstring(L, word[i]);
-		lua_rawseti(L, -2, i);
-	}
+	push_words(L, info, word, NULL, proxies);
 	u = lua_newuserdata(L, sizeof(pchat_event_attrs *));
 	*u = event_attrs_copy(attrs);
 	luaL_newmetatable(L, "attrs");
@@ -421,13 +540,17 @@ static int api_print_attrs_closure(char *word[], pchat_event_attrs *attrs, void
 	if(lua_pcall(L, 2, 1, base))
 	{
 		char const *error = lua_tostring(L, -1);
-		lua_pop(L, 2);
+		lua_pop(L, 1);
+		invalidate_words(L, proxies);
+		lua_pop(L, 1);
 		pchat_printf(ph, "Lua error in print_attrs hook: %s", error ? error : "(non-string error)");
 		check_deferred(script);
 		return PCHAT_EAT_NONE;
 	}
 	ret = lua_tointeger(L, -1);
-	lua_pop(L, 2);
+	lua_pop(L, 1);
+	invalidate_words(L, proxies);
+	lua_pop(L, 1);
 	check_deferred(script);
 	return ret;
 }
@@ -444,6 +567,7 @@ static int api_pchat_hook_print_attrs(lua_State *L)
 	info = g_new(hook_info, 1);
 	info->state = L;
 	info->ref = ref;
+	info->lazy = lua_toboolean(L, 4);
 	info->hook = pchat_hook_print_attrs(ph, event, pri, api_print_attrs_closure, info);
 	u = lua_newuserdata(L, sizeof(hook_info *));
 	*u = info;
@@ -458,34 +582,27 @@ static int api_server_closure(char *word[], char *word_eol[], void *udata)
 	hook_info *info = udata;
 	lua_State *L = info->state;
 	script_info *script = get_info(L);
-	int base, i, ret;
+	int base, ret;
+	word_proxy *proxies[2];
 
 	lua_rawgeti(L, LUA_REGISTRYINDEX, script->traceback);
 	base = lua_gettop(L);
-	lua_rawgeti(L, LUA_REGISTRYINDEX, info->ref);
-	lua_newtable(L);
-	for(i = 1; i < WORD_ARRAY_LEN && *word_eol[i]; i++)
-	{
-		lua_pushstring(L, word[i]);
-		lua_rawseti(L, -2, i);
-	}
-	lua_newtable(L);
-	for(i = 1; i < WORD_ARRAY_LEN && *word_eol[i]; i++)
-	{
-		lua_pushstring(L, word_eol[i]);
-		lua_rawseti(L, -2, i);
-	}
+	push_words(L, info, word, word_eol, proxies);
 	script->status |= STATUS_ACTIVE;
 	if(lua_pcall(L, 2, 1, base))
 	{
 		char const *error = lua_tostring(L, -1);
-		lua_pop(L, 2);
+		lua_pop(L, 1);
+		invalidate_words(L, proxies);
+		lua_pop(L, 1);
 		pchat_printf(ph, "Lua error in server hook: %s", error ? error : "(non-string error)");
 		check_deferred(script);
 		return PCHAT_EAT_NONE;
 	}
 	ret = lua_tointeger(L, -1);
-	lua_pop(L, 2);
+	lua_pop(L, 1);
+	invalidate_words(L, proxies);
+	lua_pop(L, 1);
 	check_deferred(script);
 	return ret;
 }
@@ -502,6 +619,7 @@ static int api_pchat_hook_server(lua_State *L)
 	info = g_new(hook_info, 1);
 	info->state = L;
 	info->ref = ref;
+	info->lazy = lua_toboolean(L, 4);
 	info->hook = pchat_hook_server(ph, command, pri, api_server_closure, info);
 	u = lua_newuserdata(L, sizeof(hook_info *));
 	*u = info;
@@ -516,24 +634,13 @@ static int api_server_attrs_closure(char *word[], char *word_eol[], pchat_event_
 	hook_info *info = udata;
 	lua_State *L = info->state;
 	script_info *script = get_info(L);
-	int base, i, ret;
+	int base, ret;
 	pchat_event_attrs **u;
+	word_proxy *proxies[2];
 
 	lua_rawgeti(L, LUA_REGISTRYINDEX, script->traceback);
 	base = lua_gettop(L);
-	lua_rawgeti(L, LUA_REGISTRYINDEX, info->ref);
-	lua_newtable(L);
-	for(i = 1; i < WORD_ARRAY_LEN && *word_eol[i]; i++)
-	{
-		lua_pushstring(L, word[i]);
-		lua_rawseti(L, -2, i);
-	}
-	lua_newtable(L);
-	for(i = 1; i < WORD_ARRAY_LEN && *word_eol[i]; i++)
-	{
-		lua_pushstring(L, word_eol[i]);
-		lua_rawseti(L, -2, i);
-	}
+	push_words(L, info, word, word_eol, proxies);
 
 	u = lua_newuserdata(L, sizeof(pchat_event_attrs *));
 	*u = event_attrs_copy(attrs);
@@ -543,13 +650,17 @@ static int api_server_attrs_closure(char *word[], char *word_eol[], pchat_event_
 	if(lua_pcall(L, 3, 1, base))
 	{
 		char const *error = lua_tostring(L, -1);
-		lua_pop(L, 2);
+		lua_pop(L, 1);
+		invalidate_words(L, proxies);
+		lua_pop(L, 1);
 		pchat_printf(ph, "Lua error in server_attrs hook: %s", error ? error : "(non-string error)");
 		check_deferred(script);
 		return PCHAT_EAT_NONE;
 	}
 	ret = lua_tointeger(L, -1);
-	lua_pop(L, 2);
+	lua_pop(L, 1);
+	invalidate_words(L, proxies);
+	lua_pop(L, 1);
 	check_deferred(script);
 	return ret;
 }
@@ -566,6 +677,7 @@ static int api_pchat_hook_server_attrs(lua_State *L)
 	info = g_new(hook_info, 1);
 	info->state = L;
 	info->ref = ref;
+	info->lazy = lua_toboolean(L, 4);
 	info->hook = pchat_hook_server_attrs(ph, command, pri, api_server_attrs_closure, info);
 	u = lua_newuserdata(L, sizeof(hook_info *));
 	*u = info;
@@ -610,6 +722,7 @@ static int api_pchat_hook_timer(lua_State *L)
 	info = g_new(hook_info, 1);
 	info->state = L;
 	info->ref = ref;
+	info->lazy = 0;
 	info->hook = pchat_hook_timer(ph, timeout, api_timer_closure, info);
 	u = lua_newuserdata(L, sizeof(hook_info *));
 	*u = info;
@@ -630,6 +743,7 @@ static int api_pchat_hook_unload(lua_State *L)
 	info = g_new(hook_info, 1);
 	info->state = L;
 	info->ref = ref;
+	info->lazy = 0;
 	info->hook = NULL;
 	u = lua_newuserdata(L, sizeof(hook_info *));
 	*u = info;
@@ -1084,6 +1198,15 @@ static luaL_Reg api_attrs_meta[] = {
 	{NULL, NULL}
 };
 
+static luaL_Reg api_words_meta[] = {
+	{"__index", api_words_meta_index},
+	{"__newindex", api_words_meta_newindex},
+	{"__len", api_words_meta_len},
+	{"__ipairs", api_words_meta_ipairs},
+	{"__pairs", api_words_meta_ipairs},
+	{NULL, NULL}
+};
+
 static luaL_Reg api_list_meta[] = {
 	{"__index", api_list_meta_index},
 	{"__newindex", api_list_meta_newindex},
@@ -1156,6 +1279,10 @@ static int luaopen_pchat(lua_State *L)
 	luaL_setfuncs(L, api_list_meta, 0);
 	lua_pop(L, 1);
 
+	luaL_newmetatable(L, "words");
+	luaL_setfuncs(L, api_words_meta, 0);
+	lua_pop(L, 1);
+
 	return 1;
 }
 
@@ -1184,6 +1311,31 @@ static void patch_pairs(lua_State *L)
 	lua_setglobal(L, "pairs");
 }
 
+static int ipairs_closure(lua_State *L)
+{
+	lua_settop(L, 1);
+	if(luaL_getmetafield(L, 1, "__ipairs"))
+	{
+		lua_insert(L, 1);
+		lua_call(L, 1, LUA_MULTRET);
+		return lua_gettop(L);
+	}
+	else
+	{
+		lua_pushvalue(L, lua_upvalueindex(1));
+		lua_insert(L, 1);
+		lua_call(L, 1, LUA_MULTRET);
+		return lua_gettop(L);
+	}
+}
+
+static void patch_ipairs(lua_State *L)
+{
+	lua_getglobal(L, "ipairs");
+	lua_pushcclosure(L, ipairs_closure, 1);
+	lua_setglobal(L, "ipairs");
+}
+
 static void patch_clibs(lua_State *L)
 {
 	lua_pushnil(L);
@@ -1258,7 +1410,10 @@ static void prepare_state(lua_State *L, script_info *info)
 {
 	luaL_openlibs(L);
 	if(LUA_VERSION_NUM < 502)
+	{
 		patch_pairs(L);
+		patch_ipairs(L);
+	}
 	if(LUA_VERSION_NUM > 502)
 		patch_clibs(L);
 	lua_getglobal(L, "debug");
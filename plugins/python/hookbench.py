@@ -0,0 +1,37 @@
+# Hook load for timing the Python plugin with pchat-replay.
+#
+# It hooks every PRIVMSG and "Channel Message" and reads what a typical
+# trigger script reads, so the replay numbers show what the hooks cost
+# per line. HOOKBENCH_LAZY=1 registers them with lazy=True, compare:
+#
+#   pchat-replay -d $(mktemp -d) --load=python.so --load=hookbench.py --synthetic=100000
+#   HOOKBENCH_LAZY=1 pchat-replay -d $(mktemp -d) --load=python.so --load=hookbench.py --synthetic=100000
+#
+# Without --synthetic, --emit=N times "Channel Message" on its own.
+
+import os
+
+import xchat
+
+__module_name__ = "hookbench"
+__module_version__ = "1.0"
+__module_description__ = "Python hook load for pchat-replay"
+
+LAZY = os.environ.get("HOOKBENCH_LAZY", "0") != "0"
+
+
+def on_privmsg(word, word_eol, userdata):
+    if word_eol[3].startswith(":!"):
+        return xchat.EAT_PLUGIN
+    return xchat.EAT_NONE
+
+
+def on_message(word, word_eol, userdata):
+    if word[0] == userdata:
+        return xchat.EAT_PLUGIN
+    return xchat.EAT_NONE
+
+
+xchat.hook_server("PRIVMSG", on_privmsg, lazy=LAZY)
+xchat.hook_print("Channel Message", on_message, userdata="nobody", lazy=LAZY)
+xchat.prnt("hookbench: %s hooks" % ("lazy" if LAZY else "eager"))
@@ -223,6 +223,9 @@ static PyThreadState *pTempThread;
 #define HOOK_XCHAT_ATTR 2
 #define HOOK_UNLOAD 3
 
+/* Size of the word arrays pchat hands to hooks. */
+#define WORD_ARRAY_LEN 32
+
 /* ===================================================================== */
 /* Object definitions */
 
@@ -247,6 +250,14 @@ typedef struct {
 	PyObject *dict;
 } ListItemObject;
 
+typedef struct {
+	PyObject_HEAD
+	char **word;	/* NULL once the hook has returned */
+	int join;	/* items are word[i:] joined by spaces */
+	Py_ssize_t len;
+	PyObject *items[WORD_ARRAY_LEN];
+} WordListObject;
+
 typedef struct {
 	PyObject_HEAD
 	char *name;
@@ -257,6 +268,7 @@ typedef struct {
 	PyThreadState *tstate;
 	pchat_context *context;
 	void *gui;
+	PyObject *attributes; /* Reused while nothing else holds it. */
 } PluginObject;
 
 typedef struct {
@@ -266,6 +278,7 @@ typedef struct {
 	PyObject *userdata;
 	char *name;
 	void *data; /* A handle, when type == HOOK_XCHAT */
+	int lazy; /* Pass WordList objects instead of lists. */
 } Hook;
 
 
@@ -273,6 +286,7 @@ typedef struct {
 /* Function declarations */
 
 static PyObject *Util_BuildList(char *word[]);
+static char **Util_BuildWordEol(char *word[], char **word_eol_raw);
 static void Util_Autoload();
 static char *Util_Expand(char *filename);
 
@@ -288,6 +302,10 @@ static PyObject *XChatOut_write(PyObject *self, PyObject *args);
 static void XChatOut_dealloc(PyObject *self);
 
 static PyObject *Attribute_New(pchat_event_attrs *attrs);
+static PyObject *Attribute_Get(PyObject *plugin, pchat_event_attrs *attrs);
+
+static PyObject *WordList_New(char *word[], int join);
+static void WordList_Release(PyObject *list);
 
 static void Context_dealloc(PyObject *self);
 static PyObject *Context_set(ContextObject *self, PyObject *args);
@@ -351,6 +369,7 @@ static PyTypeObject XChatOut_Type;
 static PyTypeObject Context_Type;
 static PyTypeObject ListItem_Type;
 static PyTypeObject Attribute_Type;
+static PyTypeObject WordList_Type;
 
 static PyThreadState *main_tstate = NULL;
 static void *thread_timer = NULL;
@@ -405,6 +424,33 @@ Util_BuildList(char *word[])
 	return list;
 }
 
+/* PChat doesn't provide a word_eol for print events, so we build our
+ * own here. Both the returned array and *word_eol_raw must be freed. */
+static char **
+Util_BuildWordEol(char *word[], char **word_eol_raw)
+{
+	char **word_eol;
+	int listsize = 0;
+	int next = 0;
+	int i;
+
+	while (word[listsize] && word[listsize][0])
+		listsize++;
+	word_eol = (char **) g_malloc(sizeof(char*)*(listsize+1));
+	/* First build a word clone, but NULL terminated. */
+	memcpy(word_eol, word, listsize*sizeof(char*));
+	word_eol[listsize] = NULL;
+	/* Then join it. */
+	*word_eol_raw = g_strjoinv(" ", word_eol);
+	/* And rebuild the real word_eol. */
+	for (i = 0; i != listsize; i++) {
+		word_eol[i] = *word_eol_raw+next;
+		next += strlen(word[i])+1;
+	}
+	word_eol[i] = "";
+	return word_eol;
+}
+
 static void
 Util_Autoload_from (const char *dir_name)
 {
@@ -524,29 +570,34 @@ Callback_Server(char *word[], char *word_eol[], pchat_event_attrs *attrs, void *
 	plugin = hook->plugin;
 	BEGIN_PLUGIN(plugin);
 
-	word_list = Util_BuildList(word+1);
+	if (hook->lazy)
+		word_list = WordList_New(word+1, 0);
+	else
+		word_list = Util_BuildList(word+1);
 	if (word_list == NULL) {
 		END_PLUGIN(plugin);
 		return 0;
 	}
-	word_eol_list = Util_BuildList(word_eol+1);
+	if (hook->lazy)
+		word_eol_list = WordList_New(word_eol+1, 0);
+	else
+		word_eol_list = Util_BuildList(word_eol+1);
 	if (word_eol_list == NULL) {
-		Py_DECREF(word_list);
+		WordList_Release(word_list);
 		END_PLUGIN(plugin);
 		return 0;
 	}
 
-	attributes = Attribute_New(attrs);
-
-	if (hook->type == HOOK_XCHAT_ATTR)
+	if (hook->type == HOOK_XCHAT_ATTR) {
+		attributes = Attribute_Get(plugin, attrs);
 		retobj = PyObject_CallFunction(hook->callback, "(OOOO)", word_list,
 					       word_eol_list, hook->userdata, attributes);
-	else
+		Py_XDECREF(attributes);
+	} else
 		retobj = PyObject_CallFunction(hook->callback, "(OOO)", word_list,
 					       word_eol_list, hook->userdata);
-	Py_DECREF(word_list);
-	Py_DECREF(word_eol_list);
-	Py_DECREF(attributes);
+	WordList_Release(word_list);
+	WordList_Release(word_eol_list);
 
 	if (retobj == Py_None) {
 		ret = PCHAT_EAT_NONE;
@@ -575,22 +626,28 @@ Callback_Command(char *word[], char *word_eol[], void *userdata)
 	plugin = hook->plugin;
 	BEGIN_PLUGIN(plugin);
 
-	word_list = Util_BuildList(word+1);
+	if (hook->lazy)
+		word_list = WordList_New(word+1, 0);
+	else
+		word_list = Util_BuildList(word+1);
 	if (word_list == NULL) {
 		END_PLUGIN(plugin);
 		return 0;
 	}
-	word_eol_list = Util_BuildList(word_eol+1);
+	if (hook->lazy)
+		word_eol_list = WordList_New(word_eol+1, 0);
+	else
+		word_eol_list = Util_BuildList(word_eol+1);
 	if (word_eol_list == NULL) {
-		Py_DECREF(word_list);
+		WordList_Release(word_list);
 		END_PLUGIN(plugin);
 		return 0;
 	}
 
 	retobj = PyObject_CallFunction(hook->callback, "(OOO)", word_list,
 				       word_eol_list, hook->userdata);
-	Py_DECREF(word_list);
-	Py_DECREF(word_eol_list);
+	WordList_Release(word_list);
+	WordList_Release(word_eol_list);
 
 	if (retobj == Py_None) {
 		ret = PCHAT_EAT_NONE;
@@ -615,71 +672,51 @@ Callback_Print_Attrs(char *word[], pchat_event_attrs *attrs, void *userdata)
 	PyObject *word_list;
 	PyObject *word_eol_list;
 	PyObject *attributes;
-	char **word_eol;
-	char *word_eol_raw;
-	int listsize = 0;
-	int next = 0;
-	int i;
+	char **word_eol = NULL;
+	char *word_eol_raw = NULL;
 	int ret = 0;
 	PyObject *plugin;
 
 	/* Cut off the message identifier. */
 	word += 1;
 
-	/* PChat doesn't provide a word_eol for print events, so we
-	 * build our own here. */
-	while (word[listsize] && word[listsize][0])
-		listsize++;
-	word_eol = (char **) g_malloc(sizeof(char*)*(listsize+1));
-	if (word_eol == NULL) {
-		pchat_print(ph, "Not enough memory to alloc word_eol "
-				"for python plugin callback.");
-		return 0;
-	}
-	/* First build a word clone, but NULL terminated. */
-	memcpy(word_eol, word, listsize*sizeof(char*));
-	word_eol[listsize] = NULL;
-	/* Then join it. */
-	word_eol_raw = g_strjoinv(" ", word_eol);
-	if (word_eol_raw == NULL) {
-		pchat_print(ph, "Not enough memory to alloc word_eol_raw "
-				"for python plugin callback.");
-		return 0;
-	}
-	/* And rebuild the real word_eol. */
-	for (i = 0; i != listsize; i++) {
-		word_eol[i] = word_eol_raw+next;
-		next += strlen(word[i])+1;
-	}
-	word_eol[i] = "";
+	/* Lazy lists join word_eol entries on demand. */
+	if (!hook->lazy)
+		word_eol = Util_BuildWordEol(word, &word_eol_raw);
 
 	plugin = hook->plugin;
 	BEGIN_PLUGIN(plugin);
 
-	word_list = Util_BuildList(word);
+	if (hook->lazy)
+		word_list = WordList_New(word, 0);
+	else
+		word_list = Util_BuildList(word);
 	if (word_list == NULL) {
 		g_free(word_eol_raw);
 		g_free(word_eol);
 		END_PLUGIN(plugin);
 		return 0;
 	}
-	word_eol_list = Util_BuildList(word_eol);
+	if (hook->lazy)
+		word_eol_list = WordList_New(word, 1);
+	else
+		word_eol_list = Util_BuildList(word_eol);
 	if (word_eol_list == NULL) {
 		g_free(word_eol_raw);
 		g_free(word_eol);
-		Py_DECREF(word_list);
+		WordList_Release(word_list);
 		END_PLUGIN(plugin);
 		return 0;
 	}
 
-	attributes = Attribute_New(attrs);
+	attributes = Attribute_Get(plugin, attrs);
 
 	retobj = PyObject_CallFunction(hook->callback, "(OOOO)", word_list,
 					    word_eol_list, hook->userdata, attributes);
 
-	Py_DECREF(word_list);
-	Py_DECREF(word_eol_list);
-	Py_DECREF(attributes);
+	WordList_Release(word_list);
+	WordList_Release(word_eol_list);
+	Py_XDECREF(attributes);
 
 	g_free(word_eol_raw);
 	g_free(word_eol);
@@ -705,59 +742,39 @@ Callback_Print(char *word[], void *userdata)
 	PyObject *retobj;
 	PyObject *word_list;
 	PyObject *word_eol_list;
-	char **word_eol;
-	char *word_eol_raw;
-	int listsize = 0;
-	int next = 0;
-	int i;
+	char **word_eol = NULL;
+	char *word_eol_raw = NULL;
 	int ret = 0;
 	PyObject *plugin;
 
 	/* Cut off the message identifier. */
 	word += 1;
 
-	/* PChat doesn't provide a word_eol for print events, so we
-	 * build our own here. */
-	while (word[listsize] && word[listsize][0])
-		listsize++;
-	word_eol = (char **) g_malloc(sizeof(char*)*(listsize+1));
-	if (word_eol == NULL) {
-		pchat_print(ph, "Not enough memory to alloc word_eol "
-				"for python plugin callback.");
-		return 0;
-	}
-	/* First build a word clone, but NULL terminated. */
-	memcpy(word_eol, word, listsize*sizeof(char*));
-	word_eol[listsize] = NULL;
-	/* Then join it. */
-	word_eol_raw = g_strjoinv(" ", word_eol);
-	if (word_eol_raw == NULL) {
-		pchat_print(ph, "Not enough memory to alloc word_eol_raw "
-				"for python plugin callback.");
-		return 0;
-	}
-	/* And rebuild the real word_eol. */
-	for (i = 0; i != listsize; i++) {
-		word_eol[i] = word_eol_raw+next;
-		next += strlen(word[i])+1;
-	}
-	word_eol[i] = "";
+	/* Lazy lists join word_eol entries on demand. */
+	if (!hook->lazy)
+		word_eol = Util_BuildWordEol(word, &word_eol_raw);
 
 	plugin = hook->plugin;
 	BEGIN_PLUGIN(plugin);
 
-	word_list = Util_BuildList(word);
+	if (hook->lazy)
+		word_list = WordList_New(word, 0);
+	else
+		word_list = Util_BuildList(word);
 	if (word_list == NULL) {
 		g_free(word_eol_raw);
 		g_free(word_eol);
 		END_PLUGIN(plugin);
 		return 0;
 	}
-	word_eol_list = Util_BuildList(word_eol);
+	if (hook->lazy)
+		word_eol_list = WordList_New(word, 1);
+	else
+		word_eol_list = Util_BuildList(word_eol);
 	if (word_eol_list == NULL) {
 		g_free(word_eol_raw);
 		g_free(word_eol);
-		Py_DECREF(word_list);
+		WordList_Release(word_list);
 		END_PLUGIN(plugin);
 		return 0;
 	}
@@ -766,8 +783,8 @@ Callback_Print(char *word[], void *userdata)
 	retobj = PyObject_CallFunction(hook->callback, "(OOO)", word_list,
 					       word_eol_list, hook->userdata);
 
-	Py_DECREF(word_list);
-	Py_DECREF(word_eol_list);
+	WordList_Release(word_list);
+	WordList_Release(word_eol_list);
 
 	g_free(word_eol_raw);
 	g_free(word_eol);
@@ -1067,6 +1084,244 @@ Attribute_New(pchat_event_attrs *attrs)
 	return (PyObject *) attr;
 }
 
+/* Returns a new reference to the plugin's attribute object, refilled
+ * in place unless a script kept the one from a previous hook. */
+static PyObject *
+Attribute_Get(PyObject *plugin, pchat_event_attrs *attrs)
+{
+	AttributeObject *attr;
+
+	attr = (AttributeObject *) ((PluginObject *)plugin)->attributes;
+	if (attr == NULL || Py_REFCNT(attr) != 1) {
+		Py_XDECREF(attr);
+		attr = (AttributeObject *) Attribute_New(attrs);
+		((PluginObject *)plugin)->attributes = (PyObject *) attr;
+	} else {
+		Py_XDECREF(attr->time);
+		attr->time = PyLong_FromLong((long)attrs->server_time_utc);
+	}
+	Py_XINCREF(attr);
+	return (PyObject *) attr;
+}
+
+
+/* ===================================================================== */
+/* WordList object */
+
+/* A read-only sequence over the word arrays of a hook, for hooks added
+ * with lazy=True. Entries are only converted to str when accessed. The
+ * arrays belong to pchat, so WordList_Release() converts whatever is
+ * left once the callback returns if the script kept a reference. */
+
+static PyObject *
+WordList_New(char *word[], int join)
+{
+	WordListObject *list;
+	Py_ssize_t len = 0;
+
+	while (len < WORD_ARRAY_LEN && word[len] && word[len][0])
+		len++;
+	list = PyObject_New(WordListObject, &WordList_Type);
+	if (list == NULL) {
+		PyErr_Print();
+		return NULL;
+	}
+	list->word = word;
+	list->join = join;
+	list->len = len;
+	memset(list->items, 0, sizeof(list->items));
+	return (PyObject *) list;
+}
+
+static PyObject *
+WordList_item(PyObject *self, Py_ssize_t i)
+{
+	WordListObject *list = (WordListObject *) self;
+	PyObject *o;
+
+	if (i < 0 || i >= list->len) {
+		PyErr_SetString(PyExc_IndexError, "word index out of range");
+		return NULL;
+	}
+	if (list->items[i] == NULL) {
+		if (list->word == NULL) {
+			PyErr_SetString(PyExc_RuntimeError,
+					"word list used after its hook returned");
+			return NULL;
+		}
+		if (list->join) {
+			GString *str = g_string_new(list->word[i]);
+			Py_ssize_t j;
+			for (j = i + 1; j < list->len; j++) {
+				g_string_append_c(str, ' ');
+				g_string_append(str, list->word[j]);
+			}
+			o = PyUnicode_FromString(str->str);
+			g_string_free(str, TRUE);
+		} else {
+			o = PyUnicode_FromString(list->word[i]);
+		}
+		if (o == NULL)
+			return NULL;
+		list->items[i] = o;
+	}
+	o = list->items[i];
+	Py_INCREF(o);
+	return o;
+}
+
+static Py_ssize_t
+WordList_length(PyObject *self)
+{
+	return ((WordListObject *) self)->len;
+}
+
+static PyObject *
+WordList_subscript(PyObject *self, PyObject *item)
+{
+	WordListObject *list = (WordListObject *) self;
+	Py_ssize_t start, stop, step, slicelen, i, cur;
+	PyObject *result;
+
+	if (PyIndex_Check(item)) {
+		i = PyNumber_AsSsize_t(item, PyExc_IndexError);
+		if (i == -1 && PyErr_Occurred())
+			return NULL;
+		if (i < 0)
+			i += list->len;
+		return WordList_item(self, i);
+	}
+	if (!PySlice_Check(item)) {
+		PyErr_SetString(PyExc_TypeError, "word indices must be integers or slices");
+		return NULL;
+	}
+#ifdef IS_PY3K
+	if (PySlice_GetIndicesEx(item, list->len, &start, &stop, &step, &slicelen) < 0)
+#else
+	if (PySlice_GetIndicesEx((PySliceObject *) item, list->len, &start, &stop, &step, &slicelen) < 0)
+#endif
+		return NULL;
+	result = PyList_New(slicelen);
+	if (result == NULL)
+		return NULL;
+	for (cur = start, i = 0; i < slicelen; cur += step, i++) {
+		PyObject *o = WordList_item(self, cur);
+		if (o == NULL) {
+			Py_DECREF(result);
+			return NULL;
+		}
+		PyList_SET_ITEM(result, i, o);
+	}
+	return result;
+}
+
+static PyObject *
+WordList_repr(PyObject *self)
+{
+	PyObject *list, *repr;
+
+	list = PySequence_List(self);
+	if (list == NULL)
+		return NULL;
+	repr = PyObject_Repr(list);
+	Py_DECREF(list);
+	return repr;
+}
+
+static void
+WordList_dealloc(PyObject *self)
+{
+	WordListObject *list = (WordListObject *) self;
+	int i;
+
+	for (i = 0; i != WORD_ARRAY_LEN; i++)
+		Py_XDECREF(list->items[i]);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/* Drops the callback's reference to a word list built by either
+ * WordList_New() or Util_BuildList(). */
+static void
+WordList_Release(PyObject *self)
+{
+	WordListObject *list = (WordListObject *) self;
+	PyObject *type, *value, *traceback;
+	Py_ssize_t i;
+
+	if (Py_TYPE(self) == &WordList_Type) {
+		if (Py_REFCNT(self) > 1) {
+			/* Keep the callback's exception, if any, for the
+			 * caller to print. */
+			PyErr_Fetch(&type, &value, &traceback);
+			for (i = 0; i != list->len; i++) {
+				PyObject *o = WordList_item(self, i);
+				if (o == NULL)
+					PyErr_Clear();
+				Py_XDECREF(o);
+			}
+			PyErr_Restore(type, value, traceback);
+		}
+		list->word = NULL;
+	}
+	Py_DECREF(self);
+}
+
+static PySequenceMethods WordList_as_sequence = {
+	WordList_length,	/*sq_length*/
+	0,			/*sq_concat*/
+	0,			/*sq_repeat*/
+	WordList_item,		/*sq_item*/
+};
+
+static PyMappingMethods WordList_as_mapping = {
+	WordList_length,	/*mp_length*/
+	WordList_subscript,	/*mp_subscript*/
+	0,			/*mp_ass_subscript*/
+};
+
+static PyTypeObject WordList_Type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	"xchat.WordList",	/*tp_name*/
+	sizeof(WordListObject),	/*tp_basicsize*/
+	0,			/*tp_itemsize*/
+	WordList_dealloc,	/*tp_dealloc*/
+	0,			/*tp_print*/
+	0,			/*tp_getattr*/
+	0,			/*tp_setattr*/
+	0,			/*tp_compare*/
+	WordList_repr,		/*tp_repr*/
+	0,			/*tp_as_number*/
+	&WordList_as_sequence,	/*tp_as_sequence*/
+	&WordList_as_mapping,	/*tp_as_mapping*/
+	0,			/*tp_hash*/
+        0,                      /*tp_call*/
+        0,                      /*tp_str*/
+        PyObject_GenericGetAttr,/*tp_getattro*/
+        0,                      /*tp_setattro*/
+        0,                      /*tp_as_buffer*/
+        Py_TPFLAGS_DEFAULT,     /*tp_flags*/
+        0,                      /*tp_doc*/
+        0,                      /*tp_traverse*/
+        0,                      /*tp_clear*/
+        0,                      /*tp_richcompare*/
+        0,                      /*tp_weaklistoffset*/
+        0,                      /*tp_iter*/
+        0,                      /*tp_iternext*/
+        0,                      /*tp_methods*/
+        0,                      /*tp_members*/
+        0,                      /*tp_getset*/
+        0,                      /*tp_base*/
+        0,                      /*tp_dict*/
+        0,                      /*tp_descr_get*/
+        0,                      /*tp_descr_set*/
+        0,                      /*tp_dictoffset*/
+        0,                      /*tp_init*/
+        PyType_GenericAlloc,    /*tp_alloc*/
+        0,                      /*tp_new*/
+      	PyObject_Del,          /*tp_free*/
+        0,                      /*tp_is_gc*/
+};
+
 
 /* ===================================================================== */
 /* Context object */
@@ -1453,6 +1708,7 @@ Plugin_AddHook(int type, PyObject *plugin, PyObject *callback,
 	hook->userdata = userdata;
 	hook->name = g_strdup (name);
 	hook->data = NULL;
+	hook->lazy = 0;
 	Plugin_SetHooks(plugin, g_slist_append(Plugin_GetHooks(plugin),
 					       hook));
 
@@ -1588,6 +1844,7 @@ Plugin_New(char *filename, PyObject *xcoobj)
 	Plugin_SetHooks(plugin, NULL);
 	Plugin_SetContext(plugin, pchat_get_context(ph));
 	Plugin_SetGui(plugin, NULL);
+	plugin->attributes = NULL;
 
 	/* Start a new interpreter environment for this plugin. */
 	PyEval_AcquireThread(main_tstate);
@@ -1689,6 +1946,7 @@ Plugin_dealloc(PluginObject *self)
 	g_free(self->name);
 	g_free(self->version);
 	g_free(self->description);
+	Py_XDECREF(self->attributes);
 	Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
@@ -1996,12 +2254,13 @@ Module_pchat_hook_command(PyObject *self, PyObject *args, PyObject *kwargs)
 	char *help = NULL;
 	PyObject *plugin;
 	Hook *hook;
+	int lazy = 0;
 	char *kwlist[] = {"name", "callback", "userdata",
-			  "priority", "help", 0};
+			  "priority", "help", "lazy", 0};
 
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO|Oiz:hook_command",
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO|Oizi:hook_command",
 					 kwlist, &name, &callback, &userdata,
-					 &priority, &help))
+					 &priority, &help, &lazy))
 		return NULL;
 
 	plugin = Plugin_GetCurrent();
@@ -2015,6 +2274,7 @@ Module_pchat_hook_command(PyObject *self, PyObject *args, PyObject *kwargs)
 	hook = Plugin_AddHook(HOOK_XCHAT, plugin, callback, userdata, name, NULL);
 	if (hook == NULL)
 		return NULL;
+	hook->lazy = lazy;
 
 	BEGIN_PCHAT_CALLS(NONE);
 	hook->data = (void*)pchat_hook_command(ph, name, priority,
@@ -2033,11 +2293,12 @@ Module_pchat_hook_server(PyObject *self, PyObject *args, PyObject *kwargs)
 	int priority = PCHAT_PRI_NORM;
 	PyObject *plugin;
 	Hook *hook;
-	char *kwlist[] = {"name", "callback", "userdata", "priority", 0};
+	int lazy = 0;
+	char *kwlist[] = {"name", "callback", "userdata", "priority", "lazy", 0};
 
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO|Oi:hook_server",
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO|Oii:hook_server",
 					 kwlist, &name, &callback, &userdata,
-					 &priority))
+					 &priority, &lazy))
 		return NULL;
 
 	plugin = Plugin_GetCurrent();
@@ -2051,6 +2312,7 @@ Module_pchat_hook_server(PyObject *self, PyObject *args, PyObject *kwargs)
 	hook = Plugin_AddHook(HOOK_XCHAT, plugin, callback, userdata, NULL, NULL);
 	if (hook == NULL)
 		return NULL;
+	hook->lazy = lazy;
 
 	BEGIN_PCHAT_CALLS(NONE);
 	hook->data = (void*)pchat_hook_server_attrs(ph, name, priority,
@@ -2069,11 +2331,12 @@ Module_pchat_hook_server_attrs(PyObject *self, PyObject *args, PyObject *kwargs)
 	int priority = PCHAT_PRI_NORM;
 	PyObject *plugin;
 	Hook *hook;
-	char *kwlist[] = {"name", "callback", "userdata", "priority", 0};
+	int lazy = 0;
+	char *kwlist[] = {"name", "callback", "userdata", "priority", "lazy", 0};
 
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO|Oi:hook_server",
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO|Oii:hook_server",
 					 kwlist, &name, &callback, &userdata,
-					 &priority))
+					 &priority, &lazy))
 		return NULL;
 
 	plugin = Plugin_GetCurrent();
@@ -2087,6 +2350,7 @@ Module_pchat_hook_server_attrs(PyObject *self, PyObject *args, PyObject *kwargs)
 	hook = Plugin_AddHook(HOOK_XCHAT_ATTR, plugin, callback, userdata, NULL, NULL);
 	if (hook == NULL)
 		return NULL;
+	hook->lazy = lazy;
 
 	BEGIN_PCHAT_CALLS(NONE);
 	hook->data = (void*)pchat_hook_server_attrs(ph, name, priority,
@@ -2105,11 +2369,12 @@ Module_pchat_hook_print(PyObject *self, PyObject *args, PyObject *kwargs)
 	int priority = PCHAT_PRI_NORM;
 	PyObject *plugin;
 	Hook *hook;
-	char *kwlist[] = {"name", "callback", "userdata", "priority", 0};
+	int lazy = 0;
+	char *kwlist[] = {"name", "callback", "userdata", "priority", "lazy", 0};
 
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO|Oi:hook_print",
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO|Oii:hook_print",
 					 kwlist, &name, &callback, &userdata,
-					 &priority))
+					 &priority, &lazy))
 		return NULL;
 
 	plugin = Plugin_GetCurrent();
@@ -2123,6 +2388,7 @@ Module_pchat_hook_print(PyObject *self, PyObject *args, PyObject *kwargs)
 	hook = Plugin_AddHook(HOOK_XCHAT, plugin, callback, userdata, name, NULL);
 	if (hook == NULL)
 		return NULL;
+	hook->lazy = lazy;
 
 	BEGIN_PCHAT_CALLS(NONE);
 	hook->data = (void*)pchat_hook_print(ph, name, priority,
@@ -2141,11 +2407,12 @@ Module_pchat_hook_print_attrs(PyObject *self, PyObject *args, PyObject *kwargs)
 	int priority = PCHAT_PRI_NORM;
 	PyObject *plugin;
 	Hook *hook;
-	char *kwlist[] = {"name", "callback", "userdata", "priority", 0};
+	int lazy = 0;
+	char *kwlist[] = {"name", "callback", "userdata", "priority", "lazy", 0};
 
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO|Oi:hook_print_attrs",
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO|Oii:hook_print_attrs",
 					 kwlist, &name, &callback, &userdata,
-					 &priority))
+					 &priority, &lazy))
 		return NULL;
 
 	plugin = Plugin_GetCurrent();
@@ -2159,6 +2426,7 @@ Module_pchat_hook_print_attrs(PyObject *self, PyObject *args, PyObject *kwargs)
 	hook = Plugin_AddHook(HOOK_XCHAT_ATTR, plugin, callback, userdata, name, NULL);
 	if (hook == NULL)
 		return NULL;
+	hook->lazy = lazy;
 
 	BEGIN_PCHAT_CALLS(NONE);
 	hook->data = (void*)pchat_hook_print_attrs(ph, name, priority,
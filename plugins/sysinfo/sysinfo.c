@@ -28,6 +28,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <glib.h>
+#include <gio/gio.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
 
 #include "pchat-plugin.h"
 #include "sysinfo-backend.h"
@@ -37,6 +42,12 @@
 #define DEFAULT_ANNOUNCE TRUE
 
 static pchat_plugin *ph;
+static char *client_str;
+
+/* the backends are slow (pci.ids, /proc, WMI) so they run in a GTask
+ * thread; the lock keeps two /sysinfo's from using them at the same time */
+static GMutex backend_lock;
+static int pending;
 
 static char name[] = "Sysinfo";
 static char desc[] = "Display info about your hardware and OS";
@@ -54,7 +65,7 @@ typedef struct
 static char *
 get_client (void)
 {
-	return g_strdup_printf ("PChat %s", pchat_get_info(ph, "version"));
+	return g_strdup (client_str);
 }
 
 static hwinfo hwinfos[] = {
@@ -70,6 +81,15 @@ static hwinfo hwinfos[] = {
 	{NULL, NULL, NULL, FALSE},
 };
 
+typedef struct
+{
+	char *servername;
+	char *channel;
+	gboolean announce;
+	int info; /* index into hwinfos, or -1 for the summary */
+	gboolean show[G_N_ELEMENTS(hwinfos)];
+} sysinfo_request;
+
 static gboolean sysinfo_get_bool_pref (const char *pref, gboolean def);
 
 static gboolean
@@ -81,8 +101,8 @@ should_show_info (hwinfo info)
 	return !sysinfo_get_bool_pref (hide_pref, info.def);
 }
 
-static void
-print_summary (gboolean announce)
+static char *
+collect_summary (sysinfo_request *req)
 {
 	char **strings = g_new0 (char*, G_N_ELEMENTS(hwinfos));
 	int i, x;
@@ -90,7 +110,7 @@ print_summary (gboolean announce)
 
 	for (i = 0, x = 0; hwinfos[i].name != NULL; i++)
 	{
-		if (should_show_info (hwinfos[i]))
+		if (req->show[i])
 		{
 			char *str = hwinfos[i].callback();
 			if (str)
@@ -102,10 +122,108 @@ print_summary (gboolean announce)
 	}
 
 	output = g_strjoinv (" \002\342\200\242\002 ", strings);
-	pchat_commandf (ph, "%s %s", announce ? "SAY" : "ECHO", output);
-
 	g_strfreev (strings);
-	g_free (output);
+
+	return output;
+}
+
+static void
+sysinfo_request_free (sysinfo_request *req)
+{
+	g_free (req->servername);
+	g_free (req->channel);
+	g_free (req);
+}
+
+static void
+sysinfo_thread (GTask *task, gpointer source_object, sysinfo_request *req, GCancellable *cancellable)
+{
+	char *str;
+#ifdef WIN32
+	HRESULT coinit_result;
+#endif
+
+	(void)source_object;
+	(void)cancellable;
+
+#ifdef WIN32
+	/* the WMI queries need COM on this pool thread too */
+	coinit_result = CoInitializeEx (NULL, COINIT_MULTITHREADED);
+#endif
+
+	g_mutex_lock (&backend_lock);
+	if (req->info == -1)
+		str = collect_summary (req);
+	else
+		str = hwinfos[req->info].callback();
+	g_mutex_unlock (&backend_lock);
+
+#ifdef WIN32
+	if (SUCCEEDED (coinit_result))
+		CoUninitialize ();
+#endif
+
+	g_task_return_pointer (task, str, g_free);
+}
+
+static void
+sysinfo_complete (GObject *source_object, GAsyncResult *result, gpointer user_data)
+{
+	sysinfo_request *req = g_task_get_task_data (G_TASK (result));
+	pchat_context *ctx;
+	char *str;
+
+	(void)source_object;
+	(void)user_data;
+
+	pending--;
+	str = g_task_propagate_pointer (G_TASK (result), NULL);
+
+	/* the tab may have been closed in the meantime */
+	ctx = pchat_find_context (ph, req->servername, req->channel);
+	if (!ctx || !pchat_set_context (ph, ctx))
+	{
+		g_free (str);
+		return;
+	}
+
+	if (req->info == -1)
+		pchat_commandf (ph, "%s %s", req->announce ? "SAY" : "ECHO", str);
+	else if (str)
+		pchat_commandf (ph, "%s \002%s\002: %s", req->announce ? "SAY" : "ECHO",
+							hwinfos[req->info].title, str);
+	else
+		pchat_print (ph, _("Sysinfo: Failed to get info. Either not supported or error."));
+
+	g_free (str);
+}
+
+static void
+collect_info (int info, gboolean announce)
+{
+	sysinfo_request *req;
+	GTask *task;
+	int i;
+
+	req = g_new0 (sysinfo_request, 1);
+	req->servername = g_strdup (pchat_get_info (ph, "server"));
+	req->channel = g_strdup (pchat_get_info (ph, "channel"));
+	req->announce = announce;
+	req->info = info;
+	for (i = 0; hwinfos[i].name != NULL; i++)
+		req->show[i] = should_show_info (hwinfos[i]);
+
+	pending++;
+	task = g_task_new (NULL, NULL, sysinfo_complete, NULL);
+	g_task_set_task_data (task, req, (GDestroyNotify) sysinfo_request_free);
+	g_task_run_in_thread (task, (GTaskThreadFunc) sysinfo_thread);
+	g_object_unref (task);
+}
+
+static void
+print_summary (gboolean announce)
+{
+	collect_info (-1, announce);
 }
 
 static void
@@ -117,15 +235,7 @@ print_info (char *info, gboolean announce)
 	{
 		if (!g_ascii_strcasecmp (info, hwinfos[i].name))
 		{
-			char *str = hwinfos[i].callback();
-			if (str)
-			{
-				pchat_commandf (ph, "%s \002%s\002: %s", announce ? "SAY" : "ECHO",
-									hwinfos[i].title, str);
-				g_free (str);
-			}
-			else
-				pchat_print (ph, _("Sysinfo: Failed to get info. Either not supported or error."));
+			collect_info (i, announce);
 			return;
 		}
 	}
@@ -235,6 +345,8 @@ pchat_plugin_init (pchat_plugin *plugin_handle, char **plugin_name, char **plugi
 	*plugin_desc = desc;
 	*plugin_version = version;
 
+	client_str = g_strdup_printf ("PChat %s", pchat_get_info(ph, "version"));
+
 	pchat_hook_command (ph, "SYSINFO", PCHAT_PRI_NORM, sysinfo_cb, sysinfo_help, NULL);
 
 	pchat_command (ph, "MENU ADD \"Window/Send System Info\" \"SYSINFO\"");
@@ -245,6 +357,14 @@ pchat_plugin_init (pchat_plugin *plugin_handle, char **plugin_name, char **plugi
 int
 pchat_plugin_deinit (void)
 {
+	/* a running lookup would call back into the unloaded plugin */
+	if (pending)
+	{
+		pchat_print (ph, _("Sysinfo: Still collecting info, try again in a moment.\n"));
+		return 0;
+	}
+
+	g_free (client_str);
 	pchat_command (ph, "MENU DEL \"Window/Display System Info\"");
 	pchat_printf (ph, _("%s plugin unloaded\n"), name);
 	return 1;
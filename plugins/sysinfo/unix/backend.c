@@ -24,15 +24,25 @@
 #include "format.h"
 #include "df.h"
 
+/* OS, CPU and GPU don't change while we're running, so they're looked up
+ * once. sysinfo.c never calls into the backend from two threads at once. */
+static char *os_str;
+static char *cpu_str;
+static char *gpu_str;
+
 char *sysinfo_backend_get_os(void)
 {
 	char name[bsize];
 
+	if (os_str)
+		return g_strdup (os_str);
+
 	if (xs_parse_distro (name) != 0)
 	{
 		return NULL;
 	}
 
+	os_str = g_strdup (name);
 	return g_strdup(name);
 }
 
@@ -87,6 +97,9 @@ char *sysinfo_backend_get_cpu(void)
 	double freq;
 	int giga = 0;
 
+	if (cpu_str)
+		return g_strdup (cpu_str);
+
 	if (xs_parse_cpu (model, vendor, &freq) != 0)
 	{
 		return NULL;
@@ -106,7 +119,8 @@ char *sysinfo_backend_get_cpu(void)
 	{
 		g_snprintf (buffer, bsize, "%s (%.0fMHz)", model, freq);
 	}
-	
+
+	cpu_str = g_strdup (buffer);
 	return g_strdup (buffer);
 }
 
@@ -117,6 +131,9 @@ char *sysinfo_backend_get_gpu(void)
 	char buffer[bsize];
 	int ret;
 
+	if (gpu_str)
+		return g_strdup (gpu_str);
+
 	if ((ret = xs_parse_video (vid_card)) != 0)
 	{
 		return NULL;
@@ -131,6 +148,7 @@ char *sysinfo_backend_get_gpu(void)
 		g_snprintf (buffer, bsize, "%s @ %s", vid_card, agp_bridge);
 	}
 
+	gpu_str = g_strdup (buffer);
 	return g_strdup (buffer);
 }
 
@@ -46,6 +46,9 @@ struct device {
 
 static struct device *first_dev;
 
+/* "vendor:device" -> full name, so pci.ids is only searched once per card */
+static GHashTable *fullnames;
+
 static struct device *scan_device(struct pci_dev *p)
 {
 	int how_much = 64;
@@ -120,57 +123,92 @@ int pci_find_by_class(u16 *class, char *vendor, char *device)
 		}
 	  }
 
+	  /* the pci_dev's go away with pacc, don't keep them for the next scan */
+	  while (first_dev)
+	  {
+		  d = first_dev->next;
+		  g_free (first_dev);
+		  first_dev = d;
+	  }
+
 	  pci_cleanup(pacc);
 	  return nomatch;
 }
 
-void pci_find_fullname(char *fullname, char *vendor, char *device)
+static int pci_lookup_names(char *vendorname, char *devicename, const char *vendor, const char *device)
 {
 	char buffer[bsize];
-	char vendorname[bsize/2] = "";
-	char devicename[bsize/2] = "";
 	char *position;
-	int cardfound = 0;
+	size_t vlen = strlen(vendor);
+	size_t dlen = strlen(device);
+	int vendorfound = 0;
 	FILE *fp;
 
 	fp = fopen (PCIIDS_FILE, "r");
 	if(fp == NULL)
 	{
-		g_snprintf(fullname, bsize, "%s:%s", vendor, device);
 		//sysinfo_print_error ("pci.ids file not found! You might want to adjust your pciids setting with /SYSINFO SET pciids (you can query its current value with /SYSINFO LIST).\n");
-		return;
+		return 0;
 	}
 
 	while(fgets(buffer, bsize, fp) != NULL)
 	{
-		if (!isspace(buffer[0]) && strstr(buffer, vendor) != NULL)
+		if (!vendorfound)
 		{
-			position = strstr(buffer, vendor);
-			position += 6;
-			g_strlcpy(vendorname, position, sizeof (vendorname));
-			position = strstr(vendorname, "\n");
-			*(position) = '\0';
-			break;
+			/* "vvvv  Vendor Name" */
+			if (!strncmp(buffer, vendor, vlen) && buffer[vlen] == ' ')
+			{
+				g_strlcpy(vendorname, buffer + vlen + 2, bsize/2);
+				vendorname[strcspn(vendorname, "\n")] = '\0';
+				vendorfound = 1;
+			}
+			continue;
 		}
-	}
-	while(fgets(buffer, bsize, fp) != NULL)
-	{
-		if(strstr(buffer, device) != NULL)
+
+		if (buffer[0] == '#' || buffer[0] == '\n')
+			continue;
+		/* the next vendor, this device isn't listed */
+		if (buffer[0] != '\t')
+			break;
+
+		/* "\tdddd  Device Name", subsystems are indented twice */
+		if (buffer[1] != '\t' && !strncmp(buffer + 1, device, dlen) && buffer[1 + dlen] == ' ')
 		{
-			position = strstr(buffer, device);
-			position += 6;
-			g_strlcpy(devicename, position, sizeof (devicename));
+			g_strlcpy(devicename, buffer + dlen + 3, bsize/2);
 			position = strstr(devicename, " (");
 			if (position == NULL)
 				position = strstr(devicename, "\n");
-			*(position) = '\0';
-			cardfound = 1;
-			break;
-		 }
+			if (position != NULL)
+				*(position) = '\0';
+			fclose(fp);
+			return 1;
+		}
+	}
+
+	fclose(fp);
+	return 0;
+}
+
+void pci_find_fullname(char *fullname, char *vendor, char *device)
+{
+	char vendorname[bsize/2] = "";
+	char devicename[bsize/2] = "";
+	char *key, *cached;
+
+	key = g_strdup_printf("%s:%s", vendor, device);
+	if (fullnames && (cached = g_hash_table_lookup(fullnames, key)) != NULL)
+	{
+		g_strlcpy(fullname, cached, bsize);
+		g_free(key);
+		return;
 	}
-	if (cardfound == 1)
+
+	if (pci_lookup_names(vendorname, devicename, vendor, device))
 		g_snprintf(fullname, bsize, "%s %s", vendorname, devicename);
 	else
 		g_snprintf(fullname, bsize, "%s:%s", vendor, device);
-	fclose(fp);
+
+	if (!fullnames)
+		fullnames = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	g_hash_table_insert(fullnames, key, g_strdup(fullname));
 }
@@ -30,6 +30,7 @@
 #include "text.h"
 #include "pchatc.h"
 #include "typedef.h"
+#include "debug-log.h"
 
 #ifdef WIN32
 #include <io.h>
@@ -214,6 +215,70 @@ cfg_get_str (char *cfg, const char *var, char *dest, int dest_len)
 	}
 }
 
+static guint
+cfg_name_hash (gconstpointer key)
+{
+	const char *p = key;
+	guint h = 5381;
+
+	while (*p)
+		h = (h << 5) + h + g_ascii_tolower (*p++);
+
+	return h;
+}
+
+static gboolean
+cfg_name_equal (gconstpointer a, gconstpointer b)
+{
+	return g_ascii_strcasecmp (a, b) == 0;
+}
+
+/*
+ * Parse a whole "name = value" file in one pass. Names are matched without
+ * regard to case and, as with cfg_get_str(), the first occurrence wins.
+ */
+GHashTable *
+cfg_parse (const char *cfg)
+{
+	GHashTable *table;
+	const char *name, *value, *eol;
+
+	table = g_hash_table_new_full (cfg_name_hash, cfg_name_equal, g_free, g_free);
+
+	while (*cfg)
+	{
+		eol = strchr (cfg, '\n');
+		if (!eol)
+			eol = cfg + strlen (cfg);
+
+		/* the name ends at the first space, lines without one never matched */
+		name = cfg;
+		value = memchr (cfg, ' ', eol - cfg);
+		if (value && value != name)
+		{
+			char *key = g_strndup (name, value - name);
+
+			while (*value == ' ')
+				value++;
+			if (*value == '=')
+				value++;
+			while (*value == ' ')
+				value++;
+
+			if (!g_hash_table_contains (table, key))
+				g_hash_table_insert (table, key, g_strndup (value, eol - value));
+			else
+				g_free (key);
+		}
+
+		if (*eol == 0)
+			break;
+		cfg = eol + 1;
+	}
+
+	return table;
+}
+
 static int
 cfg_put_str (int fh, char *var, char *value)
 {
@@ -558,6 +623,7 @@ const struct prefs vars[] =
 	{"text_autocopy_stamp", P_OFFINT (pchat_text_autocopy_stamp), TYPE_BOOL},
 	{"text_autocopy_text", P_OFFINT (pchat_text_autocopy_text), TYPE_BOOL},
 	{"text_background", P_OFFSET (pchat_text_background), TYPE_STR},
+	{"text_buffer_release", P_OFFINT (pchat_text_buffer_release), TYPE_INT},
 	{"text_color_nicks", P_OFFINT (pchat_text_color_nicks), TYPE_BOOL},
 	{"text_font", P_OFFSET (pchat_text_font), TYPE_STR},
 	{"text_font_main", P_OFFSET (pchat_text_font_main), TYPE_STR},
@@ -838,6 +904,7 @@ load_default_config(void)
 	prefs.pchat_net_ping_timeout = 60;
 	prefs.pchat_net_reconnect_delay = 10;
 	prefs.pchat_notify_timeout = 15;
+	prefs.pchat_text_buffer_release = 600;	/* seconds a hidden tab keeps its text widget buffer */
 	prefs.pchat_text_max_indent = 256;
 	prefs.pchat_text_max_lines = 5000;
 	prefs.pchat_url_grabber_limit = 100; 		/* 0 means unlimited */
@@ -958,8 +1025,12 @@ make_dcc_dirs (void)
 int
 load_config (void)
 {
-	char *cfg, *sp;
-	int res, val, i;
+	GHashTable *table;
+	char *cfg, *sp, *value;
+	int i;
+#ifdef PCHAT_DEBUG_LOGGING
+	gint64 start = g_get_monotonic_time ();
+#endif
 
 	g_assert(check_config_dir () == 0);
 
@@ -969,27 +1040,35 @@ load_config (void)
 	/* If the config is incomplete we have the default values loaded */
 	load_default_config();
 
+	table = cfg_parse (cfg);
+	g_free (cfg);
+
 	i = 0;
 	do
 	{
-		switch (vars[i].type)
+		value = g_hash_table_lookup (table, vars[i].name);
+		if (value)
 		{
-		case TYPE_STR:
-			cfg_get_str (cfg, vars[i].name, (char *) &prefs + vars[i].offset,
-				     vars[i].len);
-			break;
-		case TYPE_BOOL:
-		case TYPE_INT:
-			val = cfg_get_int_with_result (cfg, vars[i].name, &res);
-			if (res)
-				*((int *) &prefs + vars[i].offset) = val;
-			break;
+			switch (vars[i].type)
+			{
+			case TYPE_STR:
+				safe_strcpy ((char *) &prefs + vars[i].offset, value, vars[i].len);
+				break;
+			case TYPE_BOOL:
+			case TYPE_INT:
+				*((int *) &prefs + vars[i].offset) = atoi (value);
+				break;
+			}
 		}
 		i++;
 	}
 	while (vars[i].name);
 
-	g_free (cfg);
+#ifdef PCHAT_DEBUG_LOGGING
+	DEBUG_LOG ("CONFIG", "load_config: %u settings in %" G_GINT64_FORMAT " us",
+				  g_hash_table_size (table), g_get_monotonic_time () - start);
+#endif
+	g_hash_table_destroy (table);
 
 	if (prefs.pchat_gui_win_height < 138)
 		prefs.pchat_gui_win_height = 138;
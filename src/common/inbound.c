@@ -856,6 +856,166 @@ inbound_quit (server *serv, char *nick, char *ip, char *reason,
 	notify_set_offline (serv, nick, was_on_front_session, tags_data);
 }
 
+/* at most this many nicks are listed in a Netsplit/Netjoin summary line */
+#define NETBATCH_MAX_NICKS 30
+
+static void
+netbatch_add_nick (GString *nicks, int *count, const char *nick)
+{
+	if (*count < NETBATCH_MAX_NICKS)
+	{
+		if (nicks->len)
+			g_string_append_c (nicks, ' ');
+		g_string_append (nicks, nick);
+	}
+	else if (*count == NETBATCH_MAX_NICKS)
+	{
+		g_string_append (nicks, " ...");
+	}
+	(*count)++;
+}
+
+/* A complete netsplit batch: each channel drops all of its split users in
+ * one go and prints a single summary line instead of one Quit per user. */
+void
+inbound_netsplit (server *serv, char *servers, GPtrArray *members,
+						const message_tags_data *tags_data)
+{
+	GSList *list;
+	GString *nicks;
+	session *sess;
+	irc_batch_member *member;
+	char count_str[16];
+	int was_on_front_session = FALSE;
+	int count;
+	guint i;
+
+	nicks = g_string_sized_new (256);
+
+	for (list = sess_list; list; list = list->next)
+	{
+		sess = list->data;
+		if (sess->server != serv)
+			continue;
+
+		if (sess == current_sess)
+			was_on_front_session = TRUE;
+
+		if (sess->type == SESS_DIALOG)
+		{
+			for (i = 0; i < members->len; i++)
+			{
+				member = g_ptr_array_index (members, i);
+				if (!serv->p_cmp (sess->channel, member->nick))
+					EMIT_SIGNAL_TIMESTAMP (XP_TE_QUIT, sess, member->nick, member->reason,
+												  member->ip, NULL, 0, tags_data->timestamp);
+			}
+			continue;
+		}
+
+		if (!sess->total)
+			continue;
+
+		count = 0;
+		g_string_truncate (nicks, 0);
+		for (i = 0; i < members->len; i++)
+		{
+			member = g_ptr_array_index (members, i);
+			if (userlist_remove_bulk (sess, member->nick))
+				netbatch_add_nick (nicks, &count, member->nick);
+		}
+
+		if (count)
+		{
+			fe_userlist_numbers (sess);
+			g_snprintf (count_str, sizeof (count_str), "%d", count);
+			EMIT_SIGNAL_TIMESTAMP (XP_TE_NETSPLIT, sess, servers, count_str,
+										  nicks->str, NULL, 0, tags_data->timestamp);
+		}
+	}
+
+	g_string_free (nicks, TRUE);
+
+	for (i = 0; i < members->len; i++)
+	{
+		member = g_ptr_array_index (members, i);
+		notify_set_offline (serv, member->nick, was_on_front_session, tags_data);
+	}
+}
+
+struct netjoin_chan
+{
+	GString *nicks;
+	int count;
+};
+
+static void
+netjoin_chan_free (struct netjoin_chan *nj)
+{
+	g_string_free (nj->nicks, TRUE);
+	g_free (nj);
+}
+
+/* A complete netjoin batch: all returning users are added to their channels
+ * before a single summary line is printed per channel. */
+void
+inbound_netjoin (server *serv, char *servers, GPtrArray *members,
+					  const message_tags_data *tags_data)
+{
+	GHashTable *chans;
+	GSList *list;
+	session *sess = NULL;
+	irc_batch_member *member;
+	struct netjoin_chan *nj;
+	char *last_chan = NULL;
+	char count_str[16];
+	guint i;
+
+	chans = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) netjoin_chan_free);
+
+	for (i = 0; i < members->len; i++)
+	{
+		member = g_ptr_array_index (members, i);
+
+		/* consecutive JOINs very often target the same channel */
+		if (!last_chan || serv->p_cmp (last_chan, member->chan))
+		{
+			sess = find_channel (serv, member->chan);
+			last_chan = member->chan;
+		}
+		if (!sess)
+			continue;
+
+		nj = g_hash_table_lookup (chans, sess);
+		if (!nj)
+		{
+			nj = g_new0 (struct netjoin_chan, 1);
+			nj->nicks = g_string_sized_new (256);
+			g_hash_table_insert (chans, sess, nj);
+		}
+
+		userlist_add_bulk (sess, member->nick, member->ip, member->account,
+								 member->realname, tags_data);
+		netbatch_add_nick (nj->nicks, &nj->count, member->nick);
+	}
+
+	/* walk sess_list rather than the table so output order is stable */
+	for (list = sess_list; list; list = list->next)
+	{
+		sess = list->data;
+		nj = g_hash_table_lookup (chans, sess);
+		if (!nj)
+			continue;
+
+		fe_userlist_numbers (sess);
+		g_snprintf (count_str, sizeof (count_str), "%d", nj->count);
+		EMIT_SIGNAL_TIMESTAMP (XP_TE_NETJOIN, sess, servers, count_str,
+									  nj->nicks->str, sess->channel, 0, tags_data->timestamp);
+	}
+
+	g_hash_table_destroy (chans);
+}
+
 void
 inbound_account (server *serv, char *nick, char *account,
 					  const message_tags_data *tags_data)
@@ -1684,6 +1844,8 @@ inbound_toggle_caps (server *serv, const char *extensions_str, gboolean enable)
 			serv->have_awaynotify = enable;
 		else if (!strcmp (extension, "account-tag"))
 			serv->have_account_tag = enable;
+		else if (!strcmp (extension, "batch"))
+			serv->have_batch = enable;
 		else if (!strcmp (extension, "sasl"))
 		{
 			serv->have_sasl = enable;
@@ -1745,6 +1907,7 @@ static const char * const supported_caps[] = {
 	"invite-notify",
 	"account-tag",
 	"extended-monitor",
+	"batch",
 
 	/* ZNC */
 	"znc.in/server-time-iso",
@@ -43,6 +43,10 @@
 GSList *notify_list = 0;
 int notify_tag = 0;
 
+/* bumped whenever notify entries or their per-server records come and go,
+   so each server's notify_nicks table knows it's stale */
+static guint notify_generation = 1;
+
 
 static char *
 despacify_dup (char *str)
@@ -64,17 +68,11 @@ despacify_dup (char *str)
 }
 
 static int
-notify_netcmp (char *str, void *serv)
+notify_netcmp (char *str, void *net)
 {
-	char *net = despacify_dup (server_get_network (serv, TRUE));
-
 	if (rfc_casecmp (str, net) == 0)
-	{
-		g_free (net);
 		return 0;	/* finish & return FALSE from token_foreach() */
-	}
 
-	g_free (net);
 	return 1;	/* keep going... */
 }
 
@@ -83,15 +81,43 @@ notify_netcmp (char *str, void *serv)
 static gboolean
 notify_do_network (struct notify *notify, server *serv)
 {
+	char *net;
+	int more;
+
 	if (!notify->networks)	/* ALL networks for this nick */
 		return TRUE;
 
-	if (token_foreach (notify->networks, ',', notify_netcmp, serv))
+	net = despacify_dup (server_get_network (serv, TRUE));
+	more = token_foreach (notify->networks, ',', notify_netcmp, net);
+	g_free (net);
+
+	if (more)
 		return FALSE;	/* network list doesn't contain this one */
 
 	return TRUE;
 }
 
+/* hashed with RFC1459 folding, which folds at least as much as any
+   casemapping the server might use; lookups recheck with serv->p_cmp */
+
+static guint
+notify_nick_hash (gconstpointer key)
+{
+	const unsigned char *p = key;
+	guint h = 0;
+
+	while (*p)
+		h = (h * 31) + rfc_tolower (*p++);
+
+	return h;
+}
+
+static gboolean
+notify_nick_equal (gconstpointer a, gconstpointer b)
+{
+	return rfc_casecmp (a, b) == 0;
+}
+
 struct notify_per_server *
 notify_find_server_entry (struct notify *notify, struct server *serv)
 {
@@ -177,8 +203,42 @@ notify_load (void)
 	}
 }
 
+/* the nicks watched on this server's network, name -> notify_per_server.
+   Rebuilt when the notify list or the network name changes. */
+
+static GHashTable *
+notify_server_table (server *serv)
+{
+	struct notify_per_server *servnot;
+	const char *net = server_get_network (serv, TRUE);
+	GSList *list;
+
+	if (serv->notify_nicks && serv->notify_generation == notify_generation &&
+		 g_strcmp0 (serv->notify_network, net) == 0)
+		return serv->notify_nicks;
+
+	if (!serv->notify_nicks)
+		serv->notify_nicks = g_hash_table_new (notify_nick_hash, notify_nick_equal);
+	else
+		g_hash_table_remove_all (serv->notify_nicks);
+
+	g_free (serv->notify_network);
+	serv->notify_network = g_strdup (net);
+	serv->notify_generation = notify_generation;
+
+	for (list = notify_list; list; list = list->next)
+	{
+		servnot = notify_find_server_entry (list->data, serv);
+		/* keep the first match, like the list walk did */
+		if (servnot && !g_hash_table_contains (serv->notify_nicks, servnot->notify->name))
+			g_hash_table_insert (serv->notify_nicks, servnot->notify->name, servnot);
+	}
+
+	return serv->notify_nicks;
+}
+
 static struct notify_per_server *
-notify_find (server *serv, char *nick)
+notify_find_slow (server *serv, char *nick)
 {
 	GSList *list = notify_list;
 	struct notify_per_server *servnot;
@@ -204,6 +264,19 @@ notify_find (server *serv, char *nick)
 	return NULL;
 }
 
+static struct notify_per_server *
+notify_find (server *serv, char *nick)
+{
+	struct notify_per_server *servnot;
+
+	servnot = g_hash_table_lookup (notify_server_table (serv), nick);
+	if (!servnot || !serv->p_cmp (servnot->notify->name, nick))
+		return servnot;
+
+	/* only equal with RFC1459 folding, the server's casemapping differs */
+	return notify_find_slow (serv, nick);
+}
+
 static void
 notify_announce_offline (server * serv, struct notify_per_server *servnot,
 								 char *nick, int quiet, 
@@ -447,47 +520,47 @@ notify_send_watches (server * serv)
 /* called when receiving a ISON 303 - should this func go? */
 
 void
-notify_markonline (server *serv, char *word[], const message_tags_data *tags_data)
+notify_markonline (server *serv, char *nicks, const message_tags_data *tags_data)
 {
-	struct notify *notify;
 	struct notify_per_server *servnot;
-	GSList *list = notify_list;
-	int i, seen;
+	GHashTable *seen;
+	GHashTableIter iter;
+	GSList *offline = NULL, *list;
+	char *nick, *next;
 
-	while (list)
+	seen = g_hash_table_new (NULL, NULL);
+
+	for (nick = nicks; nick; nick = next)
 	{
-		notify = (struct notify *) list->data;
-		servnot = notify_find_server_entry (notify, serv);
-		if (!servnot)
-		{
-			list = list->next;
+		next = strchr (nick, ' ');
+		if (next)
+			*next++ = 0;
+		if (!*nick)
 			continue;
-		}
-		i = 4;
-		seen = FALSE;
-		while (*word[i])
-		{
-			if (!serv->p_cmp (notify->name, word[i]))
-			{
-				seen = TRUE;
-				notify_announce_online (serv, servnot, notify->name, tags_data);
-				break;
-			}
-			i++;
-			/* FIXME: word[] is only a 32 element array, limits notify list to
-			   about 27 people */
-			if (i > PDIWORDS - 5)
-			{
-				/*fprintf (stderr, _("*** PCHAT WARNING: notify list too large.\n"));*/
-				break;
-			}
-		}
-		if (!seen && servnot->ison)
+
+		servnot = notify_find (serv, nick);
+		if (servnot && !g_hash_table_contains (seen, servnot))
 		{
-			notify_announce_offline (serv, servnot, notify->name, FALSE, tags_data);
+			g_hash_table_add (seen, servnot);
+			notify_announce_online (serv, servnot, servnot->notify->name, tags_data);
 		}
-		list = list->next;
 	}
+
+	/* anyone we watch who wasn't in the reply is gone */
+	g_hash_table_iter_init (&iter, notify_server_table (serv));
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&servnot))
+	{
+		if (servnot->ison && !g_hash_table_contains (seen, servnot))
+			offline = g_slist_prepend (offline, servnot);
+	}
+	for (list = offline; list; list = list->next)
+	{
+		servnot = list->data;
+		notify_announce_offline (serv, servnot, servnot->notify->name, FALSE, tags_data);
+	}
+
+	g_slist_free (offline);
+	g_hash_table_destroy (seen);
 	fe_notify_update (0);
 }
 
@@ -599,6 +672,7 @@ notify_deluser (char *name)
 				g_free (servnot);
 			}
 			notify_list = g_slist_remove (notify_list, notify);
+			notify_generation++;
 			notify_watch_all (notify, FALSE);
 			g_free (notify->networks);
 			g_free (notify->name);
@@ -622,6 +696,7 @@ notify_adduser (char *name, char *networks)
 		notify->networks = despacify_dup (networks);
 	notify->server_list = 0;
 	notify_list = g_slist_prepend (notify_list, notify);
+	notify_generation++;
 	notify_checklist ();
 	fe_notify_update (notify->name);
 	fe_notify_update (0);
@@ -648,21 +723,11 @@ notify_is_in_list (server *serv, char *name)
 int
 notify_isnotify (struct session *sess, char *name)
 {
-	struct notify *notify;
 	struct notify_per_server *servnot;
-	GSList *list = notify_list;
 
-	while (list)
-	{
-		notify = (struct notify *) list->data;
-		if (!sess->server->p_cmp (notify->name, name))
-		{
-			servnot = notify_find_server_entry (notify, sess->server);
-			if (servnot && servnot->ison)
-				return TRUE;
-		}
-		list = list->next;
-	}
+	servnot = notify_find (sess->server, name);
+	if (servnot && servnot->ison)
+		return TRUE;
 
 	return FALSE;
 }
@@ -705,6 +770,7 @@ notify_cleanup ()
 				notify->server_list =
 					g_slist_remove (notify->server_list, servnot);
 				g_free (servnot);
+				notify_generation++;
 				nslist = notify->server_list;
 			} else
 			{
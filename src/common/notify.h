@@ -66,7 +66,7 @@ int notify_isnotify (session *sess, char *name);
 struct notify_per_server *notify_find_server_entry (struct notify *notify, struct server *serv);
 
 /* the old ISON stuff - remove me? */
-void notify_markonline (server *serv, char *word[], 
+void notify_markonline (server *serv, char *nicks,
 								const message_tags_data *tags_data);
 int notify_checklist (void);
 
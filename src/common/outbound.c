@@ -632,7 +632,10 @@ cmd_clear (struct session *sess, char *tbuf, char *word[], char *word_eol[])
 		{
 			sess = list->data;
 			if (!(sess->tab_state & TAB_STATE_NEW_HILIGHT))
+			{
 				fe_text_clear (list->data, 0);
+				sess->scrollback_offset = 0;
+			}
 			list = list->next;
 		}
 		return TRUE;
@@ -642,6 +645,9 @@ cmd_clear (struct session *sess, char *tbuf, char *word[], char *word_eol[])
 		return FALSE;
 
 	fe_text_clear (sess, atoi (reason));
+	/* don't page old scrollback back into a cleared window */
+	if (atoi (reason) == 0)
+		sess->scrollback_offset = 0;
 	return TRUE;
 }
 
@@ -1217,6 +1223,36 @@ menu_add (char *path, char *label, char *cmd, char *ucmd, int pos, int state, in
 	}
 }
 
+static int
+cmd_memstats (struct session *sess, char *tbuf, char *word[], char *word_eol[])
+{
+	struct server *serv;
+	GSList *list = serv_list;
+	guint unique, refs;
+	gsize bytes, saved;
+	gsize total_bytes = 0, total_saved = 0;
+
+	PrintText (sess, _("Shared user strings (host, realname, server, account):\n"));
+	while (list)
+	{
+		serv = list->data;
+		userlist_pool_stats (serv, &unique, &refs, &bytes, &saved);
+		if (refs)
+		{
+			PrintTextf (sess, _("  %s: %u strings, %u references, %" G_GSIZE_FORMAT
+									  " bytes stored, %" G_GSIZE_FORMAT " bytes saved\n"),
+							server_get_network (serv, TRUE), unique, refs, bytes, saved);
+		}
+		total_bytes += bytes;
+		total_saved += saved;
+		list = list->next;
+	}
+	PrintTextf (sess, _("Total: %" G_GSIZE_FORMAT " bytes stored, %" G_GSIZE_FORMAT
+							  " bytes saved\n"), total_bytes, total_saved);
+
+	return TRUE;
+}
+
 static int
 cmd_menu (struct session *sess, char *tbuf, char *word[], char *word_eol[])
 {
@@ -1502,7 +1538,11 @@ exec_check_process (struct session *sess)
 	if (val == -1 || val > 0)
 	{
 		close (sess->running_exec->myfd);
-		fe_input_remove (sess->running_exec->iotag);
+		if (sess->running_exec->iotag)
+			fe_input_remove (sess->running_exec->iotag);
+		if (sess->running_exec->resume_tag)
+			fe_timeout_remove (sess->running_exec->resume_tag);
+		g_free (sess->running_exec->linebuf);
 		g_free (sess->running_exec);
 		sess->running_exec = NULL;
 	}
@@ -1753,65 +1793,87 @@ exec_print_line (session *sess, char *data, gssize len, gboolean tochannel)
 	g_free (valid);
 }
 
+/* read the child's output in big chunks, so that a fast writer turns into
+ * a few large prints instead of one per 2K */
+#define EXEC_READ_SIZE 16384
+
+/* with -o, stop reading from the child while the server's send queue is
+ * above EXEC_SENDQ_HIGH bytes, and resume once it drops under EXEC_SENDQ_LOW.
+ * the child then blocks on its own full pipe. */
+#define EXEC_SENDQ_HIGH 8192
+#define EXEC_SENDQ_LOW 2048
+
+static gboolean exec_data (GIOChannel *source, GIOCondition condition, struct nbexec *s);
+
+static int
+exec_resume (struct nbexec *s)
+{
+	if (s->sess->server->sendq_len > EXEC_SENDQ_LOW)
+		return 1;
+
+	s->resume_tag = 0;
+	s->iotag = fe_input_add (s->myfd, FIA_READ|FIA_EX, exec_data, s);
+	return 0;
+}
+
 static gboolean
 exec_data (GIOChannel *source, GIOCondition condition, struct nbexec *s)
 {
-	char *buf, *readpos, *rest;
+	char *rest, save;
 	int rd, len;
 	int sok = s->myfd;
 
-	len = s->buffill;
-	if (len) {
-		/* append new data to buffered incomplete line */
-		buf = g_malloc (len + 2050);
-		memcpy(buf, s->linebuf, len);
-		readpos = buf + len;
-		g_free (s->linebuf);
-		s->linebuf = NULL;
+	/* s->linebuf holds the incomplete last line, reused across reads */
+	if (s->bufsize - s->buffill < EXEC_READ_SIZE + 1)
+	{
+		s->bufsize = s->buffill + EXEC_READ_SIZE + 1;
+		s->linebuf = g_realloc (s->linebuf, s->bufsize);
 	}
-	else
-		readpos = buf = g_malloc (2050);
 
-	rd = read (sok, readpos, 2048);
+	rd = read (sok, s->linebuf + s->buffill, EXEC_READ_SIZE);
 	if (rd < 1)
 	{
 		/* The process has died */
 		kill(s->childpid, SIGKILL);
-		if (len) {
-			buf[len] = '\0';
-			exec_print_line(s->sess, buf, len, s->tochannel);
+		if (s->buffill) {
+			s->linebuf[s->buffill] = '\0';
+			exec_print_line(s->sess, s->linebuf, s->buffill, s->tochannel);
 		}
-		g_free(buf);
 		waitpid (s->childpid, NULL, 0);
 		s->sess->running_exec = NULL;
 		fe_input_remove (s->iotag);
 		close (sok);
+		g_free (s->linebuf);
 		g_free (s);
 		return TRUE;
 	}
-	len += rd;
-	buf[len] = '\0';
+	len = s->buffill + rd;
+	s->linebuf[len] = '\0';
 
-	rest = memrchr(buf, '\n', len);
+	/* print all complete lines at once */
+	rest = memrchr(s->linebuf, '\n', len);
 	if (rest)
+	{
 		rest++;
-	else
-		rest = buf;
-	if (*rest) {
-		s->buffill = len - (rest - buf); /* = strlen(rest) */
-		s->linebuf = g_malloc (s->buffill + 1);
-		memcpy(s->linebuf, rest, s->buffill);
+		save = *rest;
 		*rest = '\0';
-		len -= s->buffill; /* possibly 0 */
+		exec_print_line(s->sess, s->linebuf, rest - s->linebuf, s->tochannel);
+		*rest = save;
+
+		/* keep the incomplete line at the start of the buffer */
+		s->buffill = len - (rest - s->linebuf);
+		memmove (s->linebuf, rest, s->buffill);
 	}
 	else
-		s->buffill = 0;
+		s->buffill = len;
 
-	if (len) {
-		exec_print_line(s->sess, buf, len, s->tochannel);
+	if (s->tochannel && s->sess->server->sendq_len > EXEC_SENDQ_HIGH)
+	{
+		fe_input_remove (s->iotag);
+		s->iotag = 0;
+		s->resume_tag = fe_timeout_add (250, exec_resume, s);
 	}
 
-	g_free (buf);
 	return TRUE;
 }
 
@@ -4069,6 +4131,8 @@ const struct commands xc_cmds[] = {
 	 N_("MDEOP, Mass deop's all chanops in the current channel (needs chanop)")},
 	{"ME", cmd_me, 0, 0, 1,
 	 N_("ME <action>, sends the action to the current channel (actions are written in the 3rd person, like /me jumps)")},
+	{"MEMSTATS", cmd_memstats, 0, 0, 1,
+	 N_("MEMSTATS, shows how much memory the shared userlist strings take and save")},
 	{"MENU", cmd_menu, 0, 0, 1, "MENU [-eX] [-i<ICONFILE>] [-k<mod>,<key>] [-m] [-pX] [-r<X,group>] [-tX] {ADD|DEL} <path> [command] [unselect command]\n"
 										 "       See http://hexchat.readthedocs.org/en/latest/plugins.html#controlling-the-gui for more details."},
 	{"MHOP", cmd_mhop, 1, 1, 1,
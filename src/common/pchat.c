@@ -65,6 +65,7 @@ GSList *command_list = 0;
 GSList *ctcp_list = 0;
 GSList *replace_list = 0;
 GSList *sess_list = 0;
+static GHashTable *sess_set = NULL;	/* the same sessions, for is_session () */
 GSList *dcc_list = 0;
 GSList *ignore_list = 0;
 GSList *usermenu_list = 0;
@@ -184,7 +185,7 @@ lastact_getfirst(int (*filter) (session *sess))
 int
 is_session (session * sess)
 {
-	return g_slist_find (sess_list, sess) ? 1 : 0;
+	return sess_set && g_hash_table_contains (sess_set, sess);
 }
 
 session *
@@ -505,6 +506,9 @@ session_new (server *serv, char *from, int type, int focus)
 	}
 
 	sess_list = g_slist_prepend (sess_list, sess);
+	if (!sess_set)
+		sess_set = g_hash_table_new (NULL, NULL);
+	g_hash_table_add (sess_set, sess);
 
 	fe_new_window (sess, focus);
 
@@ -569,7 +573,10 @@ exec_notify_kill (session * sess)
 		sess->running_exec = NULL;
 		kill (re->childpid, SIGKILL);
 		waitpid (re->childpid, NULL, WNOHANG);
-		fe_input_remove (re->iotag);
+		if (re->iotag)
+			fe_input_remove (re->iotag);
+		if (re->resume_tag)
+			fe_timeout_remove (re->resume_tag);
 		close (re->myfd);
 		g_free (re->linebuf);
 		g_free (re);
@@ -661,6 +668,7 @@ session_free (session *killsess)
 		killserv->server_session = killserv->front_session;
 
 	sess_list = g_slist_remove (sess_list, killsess);
+	g_hash_table_remove (sess_set, killsess);
 
 	if (killsess->type == SESS_CHANNEL)
 		userlist_free (killsess);
@@ -88,6 +88,8 @@ struct nbexec
 	int iotag;
 	char *linebuf;
 	int buffill;
+	int bufsize;						/* allocated size of linebuf */
+	int resume_tag;					/* waiting for the send queue to drain */
 	struct session *sess;
 };
 
@@ -276,6 +278,7 @@ struct pchatprefs
 	int pchat_net_proxy_use;				/* 0=all 1=IRC_ONLY 2=DCC_ONLY */
 	int pchat_net_reconnect_delay;
 	int pchat_notify_timeout;
+	int pchat_text_buffer_release;
 	int pchat_text_max_indent;
 	int pchat_text_max_lines;
 	int pchat_url_grabber_limit;
@@ -378,6 +381,7 @@ typedef struct session
 
 	struct server *server;
 	tree *usertree;					/* alphabetical tree */
+	tree *completion_tree;			/* users by case-folded nick, for tab completion */
 	struct User *me;					/* points to myself in the usertree */
 	char channel[CHANLEN];
 	char waitchannel[CHANLEN];		  /* waiting to join channel (/join sent) */
@@ -389,6 +393,7 @@ typedef struct session
 
 	GFile *scrollfile;							/* scrollback file */
 	int scrollwritten;					/* number of lines written */
+	goffset scrollback_offset;			/* scrollback bytes not replayed yet */
 
 	char lastnick[NICKLEN];			  /* last nick you /msg'ed */
 
@@ -494,7 +499,13 @@ typedef struct server
 #ifdef USE_OPENSSL
 	SSL_CTX *ctx;
 	SSL *ssl;
-	int ssl_do_connect_tag;
+	int ssl_do_connect_tag;		/* safety-net timer for the handshake */
+	int ssl_do_connect_iotag;		/* socket watch driving the handshake */
+	int ssl_do_connect_flags;		/* FIA_ flags ssl_do_connect_iotag waits for */
+	time_t ssl_handshake_start;	/* for the handshake timeout */
+	SSL_SESSION *ssl_session;		/* last resumable session, offered on reconnect */
+	char *ssl_session_host;			/* ...but only to the host and port it came from */
+	int ssl_session_port;
 #else
 	void *ssl;
 #endif
@@ -551,6 +562,12 @@ typedef struct server
 
 	GSList *favlist;			/* list of channels & keys to join */
 
+	GHashTable *batches;		/* open IRCv3 batches, id -> irc_batch */
+	GHashTable *user_strings;	/* shared User host/realname/account strings, see userlist.c */
+	GHashTable *notify_nicks;	/* watched nicks on this network, see notify.c */
+	char *notify_network;		/* network notify_nicks was built for */
+	guint notify_generation;
+
 	unsigned int motd_skipped:1;
 	unsigned int connected:1;
 	unsigned int connecting:1;
@@ -577,6 +594,7 @@ typedef struct server
 	unsigned int have_extjoin:1;	/* cap extended-join */
 	unsigned int have_account_tag:1;	/* cap account-tag */
 	unsigned int have_server_time:1;	/* cap server-time */
+	unsigned int have_batch:1;		/* cap batch */
 	unsigned int have_sasl:1;		/* SASL capability */
 	unsigned int have_except:1;	/* ban exemptions +e */
 	unsigned int have_invite:1;	/* invite exemptions +I */
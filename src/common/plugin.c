@@ -1818,8 +1818,77 @@ pchat_free (pchat_plugin *ph, void *ptr)
 	g_free (ptr);
 }
 
+/* parsed addon_*.conf files, so that gets don't reread them every time */
+
+typedef struct
+{
+	GHashTable *values;	/* name -> escaped value, see cfg_parse() */
+	time_t mtime;			/* to notice the file being edited by hand */
+	goffset size;
+} pluginpref_cache;
+
+static GHashTable *pluginpref_files = NULL;	/* path -> pluginpref_cache */
+
+static void
+pluginpref_cache_free (pluginpref_cache *cache)
+{
+	g_hash_table_destroy (cache->values);
+	g_free (cache);
+}
+
+static char *
+pluginpref_filename (pchat_plugin *pl)
+{
+	char *canon, *confname;
+
+	canon = g_strdup (pl->name);
+	canonalize_key (canon);
+	confname = g_strdup_printf ("%s%caddon_%s.conf", get_xdir(), G_DIR_SEPARATOR, canon);
+	g_free (canon);
+
+	return confname;
+}
+
+static GHashTable *
+pluginpref_load (const char *confname)
+{
+	pluginpref_cache *cache;
+	GStatBuf st;
+	char *cfg;
+
+	if (!pluginpref_files)
+		pluginpref_files = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+																(GDestroyNotify) pluginpref_cache_free);
+
+	if (g_stat (confname, &st) != 0)
+	{
+		g_hash_table_remove (pluginpref_files, confname);
+		return NULL;
+	}
+
+	cache = g_hash_table_lookup (pluginpref_files, confname);
+	if (cache && cache->mtime == st.st_mtime && cache->size == st.st_size)
+		return cache->values;
+
+	if (!g_file_get_contents (confname, &cfg, NULL, NULL))
+	{
+		g_hash_table_remove (pluginpref_files, confname);
+		return NULL;
+	}
+
+	cache = g_new (pluginpref_cache, 1);
+	cache->values = cfg_parse (cfg);
+	cache->mtime = st.st_mtime;
+	cache->size = st.st_size;
+	g_free (cfg);
+
+	g_hash_table_replace (pluginpref_files, g_strdup (confname), cache);
+
+	return cache->values;
+}
+
 static int
-pchat_pluginpref_set_str_real (pchat_plugin *pl, const char *var, const char *value, int mode) /* mode: 0 = delete, 1 = save */
+pluginpref_write (pchat_plugin *pl, const char *var, const char *value, int mode) /* mode: 0 = delete, 1 = save */
 {
 	FILE *fpIn;
 	int fhOut;
@@ -1963,6 +2032,27 @@ pchat_pluginpref_set_str_real (pchat_plugin *pl, const char *var, const char *va
 	}
 }
 
+static int
+pchat_pluginpref_set_str_real (pchat_plugin *pl, const char *var, const char *value, int mode) /* mode: 0 = delete, 1 = save */
+{
+	char *confname;
+
+	if (!pluginpref_write (pl, var, value, mode))
+		return 0;
+
+	if (!pluginpref_files)
+		return 1;
+
+	/* the writer matches names case-sensitively but the cache doesn't,
+	   so patching the cached copy could disagree with the file; just
+	   parse it again on the next get */
+	confname = pluginpref_filename (pl);
+	g_hash_table_remove (pluginpref_files, confname);
+	g_free (confname);
+
+	return 1;
+}
+
 int
 pchat_pluginpref_set_str (pchat_plugin *pl, const char *var, const char *value)
 {
@@ -1972,32 +2062,22 @@ pchat_pluginpref_set_str (pchat_plugin *pl, const char *var, const char *value)
 static int
 pchat_pluginpref_get_str_real (pchat_plugin *pl, const char *var, char *dest, int dest_len)
 {
-	char *confname, *canon, *cfg, *unescaped_value;
+	GHashTable *values;
+	char *confname, *value, *unescaped_value;
 	char buf[512];
 
-	canon = g_strdup (pl->name);
-	canonalize_key (canon);
-	confname = g_strdup_printf ("%s%caddon_%s.conf", get_xdir(), G_DIR_SEPARATOR, canon);
-	g_free (canon);
-
-	if (!g_file_get_contents (confname, &cfg, NULL, NULL))
-	{
-		g_free (confname);
-		return 0;
-	}
+	confname = pluginpref_filename (pl);
+	values = pluginpref_load (confname);
 	g_free (confname);
 
-	if (!cfg_get_str (cfg, var, buf, sizeof(buf)))
-	{
-		g_free (cfg);
+	if (!values || !(value = g_hash_table_lookup (values, var)))
 		return 0;
-	}
 
+	g_strlcpy (buf, value, sizeof (buf));
 	unescaped_value = g_strcompress (buf);
 	g_strlcpy (dest, unescaped_value, dest_len);
 
 	g_free (unescaped_value);
-	g_free (cfg);
 	return 1;
 }
 
@@ -542,8 +542,8 @@ process_numeric (session * sess, int n,
 		else goto def;
 
 	case 303:
-		word[4]++;
-		notify_markonline (serv, word, tags_data);
+		notify_markonline (serv, word_eol[4][0] == ':' ? word_eol[4] + 1 : word_eol[4],
+								 tags_data);
 		break;
 
 	case 305:
@@ -1007,6 +1007,185 @@ process_numeric (session * sess, int n,
 	}
 }
 
+/* IRCv3 batches
+ *
+ * Lines tagged with the id of an open netsplit/netjoin batch are queued and
+ * handled all at once when the batch ends, so a split of thousands of users
+ * is one pass over the userlists and one line per channel.
+ *
+ * See https://ircv3.net/specs/extensions/batch
+ */
+
+static void
+batch_member_free (irc_batch_member *member)
+{
+	g_free (member->nick);
+	g_free (member->ip);
+	g_free (member->chan);
+	g_free (member->account);
+	g_free (member->realname);
+	g_free (member->reason);
+	g_free (member);
+}
+
+void
+proto_batch_free (irc_batch *batch)
+{
+	g_free (batch->id);
+	g_free (batch->type);
+	g_free (batch->params);
+	g_ptr_array_free (batch->members, TRUE);
+	g_free (batch);
+}
+
+static gboolean
+batch_is_netsplit (irc_batch *batch)
+{
+	return !g_ascii_strcasecmp (batch->type, "netsplit");
+}
+
+static gboolean
+batch_is_netjoin (irc_batch *batch)
+{
+	return !g_ascii_strcasecmp (batch->type, "netjoin");
+}
+
+/* process whatever a netsplit/netjoin batch has queued so far */
+static void
+batch_flush (server *serv, irc_batch *batch)
+{
+	message_tags_data tags_data = MESSAGE_TAGS_DATA_INIT;
+	GPtrArray *members = batch->members;
+	char *params;
+
+	if (!members->len)
+		return;
+
+	/* plugins run from the print events below may end up dropping the batch,
+	 * so hand the queue over before touching it */
+	batch->members = g_ptr_array_new_with_free_func ((GDestroyNotify) batch_member_free);
+	params = g_strdup (batch->params);
+	tags_data.timestamp = batch->timestamp;
+
+	if (batch_is_netsplit (batch))
+		inbound_netsplit (serv, params, members, &tags_data);
+	else
+		inbound_netjoin (serv, params, members, &tags_data);
+
+	g_ptr_array_free (members, TRUE);
+	g_free (params);
+}
+
+static void
+batch_open (server *serv, char *id, char *type, char *params,
+				const message_tags_data *tags_data)
+{
+	irc_batch *batch;
+
+	if (!serv->batches)
+		serv->batches = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+															(GDestroyNotify) proto_batch_free);
+
+	batch = g_new0 (irc_batch, 1);
+	batch->id = g_strdup (id);
+	batch->type = g_strdup (type);
+	batch->params = g_strdup (params);
+	batch->timestamp = tags_data->timestamp;
+	batch->members = g_ptr_array_new_with_free_func ((GDestroyNotify) batch_member_free);
+
+	g_hash_table_replace (serv->batches, batch->id, batch);
+}
+
+static void
+batch_close (server *serv, char *id)
+{
+	irc_batch *batch;
+
+	if (!serv->batches)
+		return;
+
+	batch = g_hash_table_lookup (serv->batches, id);
+	if (!batch)
+		return;
+
+	g_hash_table_steal (serv->batches, id);
+	if (batch_is_netsplit (batch) || batch_is_netjoin (batch))
+		batch_flush (serv, batch);
+	proto_batch_free (batch);
+}
+
+/* BATCH +id type [params...] / BATCH -id */
+static void
+handle_batch (server *serv, char *word[], char *word_eol[],
+				  const message_tags_data *tags_data)
+{
+	char *ref = word[3];
+
+	if (ref[0] == '+' && ref[1])
+		batch_open (serv, ref + 1, word[4], word_eol[5], tags_data);
+	else if (ref[0] == '-' && ref[1])
+		batch_close (serv, ref + 1);
+}
+
+/* Queue a QUIT/JOIN that belongs to an open netsplit/netjoin batch.
+ * Returns TRUE if the message was queued, FALSE if it must be handled now. */
+static gboolean
+batch_queue (server *serv, const message_tags_data *tags_data, char *type,
+				 char *nick, char *ip, char *word[], char *word_eol[])
+{
+	irc_batch *batch;
+	irc_batch_member *member;
+	char *chan, *account, *realname;
+
+	if (!tags_data->batch || !serv->batches)
+		return FALSE;
+
+	batch = g_hash_table_lookup (serv->batches, tags_data->batch);
+	if (!batch)
+		return FALSE;
+
+	if (batch_is_netsplit (batch) && !g_ascii_strcasecmp (type, "QUIT"))
+	{
+		member = g_new0 (irc_batch_member, 1);
+		member->nick = g_strdup (nick);
+		member->ip = g_strdup (ip);
+		member->reason = g_strdup (STRIP_COLON (word, word_eol, 3));
+		g_ptr_array_add (batch->members, member);
+		return TRUE;
+	}
+
+	if (batch_is_netjoin (batch) && !g_ascii_strcasecmp (type, "JOIN")
+		 && serv->p_cmp (nick, serv->nick))
+	{
+		chan = word[3];
+		account = word[4];
+		realname = word_eol[5];
+
+		if (*chan == ':')
+			chan++;
+		if (account && strcmp (account, "*") == 0)
+			account = NULL;
+		if (realname && *realname == ':')
+			realname++;
+
+		member = g_new0 (irc_batch_member, 1);
+		member->nick = g_strdup (nick);
+		member->ip = g_strdup (ip);
+		member->chan = g_strdup (chan);
+		member->account = g_strdup (account);
+		member->realname = g_strdup (realname);
+		g_ptr_array_add (batch->members, member);
+		return TRUE;
+	}
+
+	/* anything else inside the batch (e.g. MODEs restoring ops after a
+	 * netjoin) must see the users queued before it */
+	if (batch_is_netsplit (batch) || batch_is_netjoin (batch))
+		batch_flush (serv, batch);
+
+	return FALSE;
+}
+
 /* handle named messages that starts with a ':' */
 
 static void
@@ -1033,6 +1212,8 @@ process_named_msg (session *sess, char *type, char *word[], char *word_eol[],
 		ex[0] = '!';
 	}
 
+	if (batch_queue (serv, tags_data, type, nick, ip, word, word_eol))
+		return;
 
 	/** Update the account for this message's source. */
 	if (serv->have_account_tag)
@@ -1194,6 +1375,10 @@ process_named_msg (session *sess, char *type, char *word[], char *word_eol[],
 			inbound_account (serv, nick, STRIP_COLON(word, word_eol, 3), tags_data);
 			return;
 
+		case WORDL('B','A','T','C'):
+			handle_batch (serv, word, word_eol, tags_data);
+			return;
+
 		case WORDL('A', 'U', 'T', 'H'):
 			inbound_sasl_authenticate (sess->server, word_eol[3]);
 			return;
@@ -1558,6 +1743,9 @@ handle_message_tags (server *serv, const char *tags_str,
 
 		if (serv->have_server_time && !strcmp (key, "time"))
 			handle_message_tag_time (value, tags_data);
+
+		if (serv->have_batch && !strcmp (key, "batch"))
+			tags_data->batch = g_strdup (value);
 	}
 	
 	g_strfreev (tags);
@@ -1661,6 +1849,7 @@ void
 message_tags_data_free (message_tags_data *tags_data)
 {
 	g_clear_pointer (&tags_data->account, g_free);
+	g_clear_pointer (&tags_data->batch, g_free);
 }
 
 void
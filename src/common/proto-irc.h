@@ -28,6 +28,7 @@
 		NULL, /* account name */		\
 		FALSE, /* identified to nick */ \
 		(time_t)0, /* timestamp */		\
+		NULL, /* batch id */			\
 	}
 
 #define STRIP_COLON(word, word_eol, idx) (word)[(idx)][0] == ':' ? (word_eol)[(idx)]+1 : (word)[(idx)]
@@ -41,9 +42,34 @@ typedef struct
 	char *account;
 	gboolean identified;
 	time_t timestamp;
+	char *batch;
 } message_tags_data;
 
+/* A message held back while its IRCv3 batch is still open
+ *
+ * See https://ircv3.net/specs/extensions/batch
+ */
+typedef struct
+{
+	char *nick;
+	char *ip;
+	char *chan;			/* netjoin only */
+	char *account;		/* netjoin only */
+	char *realname;		/* netjoin only */
+	char *reason;		/* netsplit only */
+} irc_batch_member;
+
+typedef struct
+{
+	char *id;
+	char *type;			/* e.g. "netsplit", "netjoin" */
+	char *params;		/* everything after the type */
+	time_t timestamp;	/* of the opening BATCH line */
+	GPtrArray *members;	/* irc_batch_member, queued until the batch ends */
+} irc_batch;
+
 void message_tags_data_free (message_tags_data *tags_data);
+void proto_batch_free (irc_batch *batch);
 
 void proto_fill_her_up (server *serv);
 
@@ -279,7 +279,7 @@ close_socket (int sok)
 
 /* handle 1 line of text received from the server */
 
-static void
+void
 server_inline (server *serv, char *line, gssize len)
 {
 	gsize len_utf8;
@@ -463,6 +463,11 @@ server_stopconnecting (server * serv)
 		fe_timeout_remove (serv->ssl_do_connect_tag);
 		serv->ssl_do_connect_tag = 0;
 	}
+	if (serv->ssl_do_connect_iotag)
+	{
+		fe_input_remove (serv->ssl_do_connect_iotag);
+		serv->ssl_do_connect_iotag = 0;
+	}
 #endif
 
 	fe_progressbar_end (serv);
@@ -512,21 +517,91 @@ ssl_cb_verify (int ok, X509_STORE_CTX * ctx)
 	return TRUE;
 }
 
+/* OpenSSL hands over each new session here, including TLS 1.3 tickets
+   that only arrive after the handshake; keep the latest for reconnects */
+static int
+ssl_cb_new_session (SSL *ssl, SSL_SESSION *session)
+{
+	server *serv = SSL_get_app_data (ssl);
+
+	if (!serv || !SSL_SESSION_is_resumable (session))
+		return 0;
+
+	if (serv->ssl_session)
+		SSL_SESSION_free (serv->ssl_session);
+	serv->ssl_session = session;
+	g_free (serv->ssl_session_host);
+	serv->ssl_session_host = g_strdup (serv->hostname);
+	serv->ssl_session_port = serv->port;
+
+	return 1;	/* we keep the reference */
+}
+
+static void
+ssl_forget_session (server *serv)
+{
+	if (serv->ssl_session)
+	{
+		SSL_SESSION_free (serv->ssl_session);
+		serv->ssl_session = NULL;
+	}
+	g_clear_pointer (&serv->ssl_session_host, g_free);
+}
+
+static void
+ssl_connect_fail (server *serv, char *reason)
+{
+	ssl_forget_session (serv);
+	EMIT_SIGNAL (XP_TE_CONNFAIL, serv->server_session, reason, NULL,
+					 NULL, NULL, 0);
+	server_cleanup (serv); /* ->connecting = FALSE */
+
+	if (prefs.pchat_net_auto_reconnectonfail)
+		auto_reconnect (serv, FALSE, -1);
+}
+
+static int ssl_do_connect (server * serv);
+
+static gboolean
+ssl_do_connect_io (GIOChannel *source, GIOCondition condition, server *serv)
+{
+	ssl_do_connect (serv);
+	return TRUE;	/* ssl_do_connect () removes the watch once it's done */
+}
+
+/* wake up ssl_do_connect () as soon as the socket is ready for whatever
+   the handshake is waiting on */
+static void
+ssl_watch_socket (server *serv, int flags)
+{
+	if (serv->ssl_do_connect_iotag)
+	{
+		if (serv->ssl_do_connect_flags == flags)
+			return;
+		fe_input_remove (serv->ssl_do_connect_iotag);
+	}
+	serv->ssl_do_connect_flags = flags;
+	serv->ssl_do_connect_iotag = fe_input_add (serv->sok, flags,
+															 ssl_do_connect_io, serv);
+}
+
 static int
 ssl_do_connect (server * serv)
 {
 	char buf[256]; // ERR_error_string() MUST have this size
+	int ret, want = SSL_ERROR_NONE;
 
 	g_sess = serv->server_session;
 
 	/* Set SNI hostname before connect */
 	SSL_set_tlsext_host_name(serv->ssl, serv->hostname);
 
-	if (SSL_connect (serv->ssl) <= 0)
+	if ((ret = SSL_connect (serv->ssl)) <= 0)
 	{
 		char err_buf[128];
 		int err;
 
+		want = SSL_get_error (serv->ssl, ret);
 		g_sess = NULL;
 		if ((err = ERR_get_error ()) > 0)
 		{
@@ -538,6 +613,7 @@ ssl_do_connect (server * serv)
 			if (ERR_GET_REASON (err) == SSL_R_WRONG_VERSION_NUMBER)
 				PrintText (serv->server_session, _("Are you sure this is a SSL capable server and port?\n"));
 
+			ssl_forget_session (serv);
 			server_cleanup (serv);
 
 			if (prefs.pchat_net_auto_reconnectonfail)
@@ -545,6 +621,17 @@ ssl_do_connect (server * serv)
 
 			return (0);				  /* remove it (0) */
 		}
+
+		/* closed or reset without anything in the error queue; the socket
+		   stays readable, so waiting for it would only spin */
+		if (want != SSL_ERROR_WANT_READ && want != SSL_ERROR_WANT_WRITE)
+		{
+			g_snprintf (buf, sizeof (buf), "SSL handshake failed: %s",
+						 want == SSL_ERROR_SYSCALL && sock_error () ?
+						 errorstring (sock_error ()) : _("Connection closed"));
+			ssl_connect_fail (serv, buf);
+			return (0);				  /* remove it (0) */
+		}
 	}
 	g_sess = NULL;
 
@@ -613,6 +700,12 @@ ssl_do_connect (server * serv)
 					 chiper_info->chiper_bits);
 		EMIT_SIGNAL (XP_TE_SSLMESSAGE, serv->server_session, buf, NULL, NULL, NULL,
 						 0);
+		if (SSL_session_reused (serv->ssl))
+		{
+			g_snprintf (buf, sizeof (buf), "* Session resumed");
+			EMIT_SIGNAL (XP_TE_SSLMESSAGE, serv->server_session, buf, NULL, NULL,
+							 NULL, 0);
+		}
 
 		verify_error = SSL_get_verify_result (serv->ssl);
 		switch (verify_error)
@@ -656,6 +749,7 @@ conn_fail:
 			EMIT_SIGNAL (XP_TE_CONNFAIL, serv->server_session, buf, NULL, NULL,
 							 NULL, 0);
 
+			ssl_forget_session (serv);
 			server_cleanup (serv);
 
 			return (0);
@@ -669,20 +763,15 @@ conn_fail:
 		return (0);					  /* remove it (0) */
 	} else
 	{
-		SSL_SESSION *session = SSL_get_session (serv->ssl);
-		if (session && SSL_SESSION_get_time_ex (session) + SSLTMOUT < time (NULL))
+		/* not the session's time, a resumed session carries the old one */
+		if (serv->ssl_handshake_start + SSLTMOUT < time (NULL))
 		{
 			g_snprintf (buf, sizeof (buf), "SSL handshake timed out");
-			EMIT_SIGNAL (XP_TE_CONNFAIL, serv->server_session, buf, NULL,
-							 NULL, NULL, 0);
-			server_cleanup (serv); /* ->connecting = FALSE */
-
-			if (prefs.pchat_net_auto_reconnectonfail)
-				auto_reconnect (serv, FALSE, -1);
-
+			ssl_connect_fail (serv, buf);
 			return (0);				  /* remove it (0) */
 		}
 
+		ssl_watch_socket (serv, want == SSL_ERROR_WANT_WRITE ? FIA_WRITE : FIA_READ);
 		return (1);					  /* call it more (1) */
 	}
 }
@@ -766,7 +855,7 @@ static void
 server_connect_success (server *serv)
 {
 #ifdef USE_OPENSSL
-#define	SSLDOCONNTMOUT	300
+#define	SSLDOCONNTMOUT	1000	/* ms, only a safety net; the socket watch drives the handshake */
 	if (serv->use_ssl)
 	{
 		char *err;
@@ -781,11 +870,19 @@ server_connect_success (server *serv)
 			return;
 		}
 		serv->ssl = _SSL_socket (serv->ctx, serv->sok);
+		serv->ssl_handshake_start = time (NULL);
+		SSL_set_app_data (serv->ssl, serv);
+		/* offer the last session, if it was with this same host */
+		if (serv->ssl_session && serv->ssl_session_port == serv->port &&
+			 !g_strcmp0 (serv->ssl_session_host, serv->hostname))
+			SSL_set_session (serv->ssl, serv->ssl_session);
 		/* FIXME: it'll be needed by new servers */
 		/* send(serv->sok, "STLS\r\n", 6, 0); sleep(1); */
 		set_nonblocking (serv->sok);
 		serv->ssl_do_connect_tag = fe_timeout_add (SSLDOCONNTMOUT,
 																 ssl_do_connect, serv);
+		/* send the ClientHello now instead of a tick from now */
+		ssl_do_connect (serv);
 		return;
 	}
 
@@ -1558,6 +1655,7 @@ server_connect (server *serv, char *hostname, int port, int no_login)
 			fprintf (stderr, "_SSL_context_init failed\n");
 			exit (1);
 		}
+		SSL_CTX_sess_set_new_cb (serv->ctx, ssl_cb_new_session);
 		DEBUG_LOG("SERVER", "SSL context initialized successfully");
 	}
 #endif
@@ -1777,6 +1875,9 @@ server_set_defaults (server *serv)
 #ifdef USE_OPENSSL
         g_clear_pointer (&serv->scram_session, scram_session_free);
 #endif
+	/* batches never survive a reconnect */
+	if (serv->batches)
+		g_hash_table_remove_all (serv->batches);
 	serv->chantypes = g_strdup ("#&!+");
 	serv->chanmodes = g_strdup ("beI,k,l");
 	serv->nick_prefixes = g_strdup ("@%+");
@@ -1805,6 +1906,7 @@ server_set_defaults (server *serv)
 	serv->have_extjoin = FALSE;
 	serv->have_account_tag = FALSE;
 	serv->have_server_time = FALSE;
+	serv->have_batch = FALSE;
 	serv->have_sasl = FALSE;
 	serv->have_except = FALSE;
 	serv->have_invite = FALSE;
@@ -1940,12 +2042,21 @@ server_free (server *serv)
 	g_free (serv->last_away_reason);
 	g_free (serv->encoding);
 
+	if (serv->batches)
+		g_hash_table_destroy (serv->batches);
+	if (serv->user_strings)
+		g_hash_table_destroy (serv->user_strings);
+	if (serv->notify_nicks)
+		g_hash_table_destroy (serv->notify_nicks);
+	g_free (serv->notify_network);
+
 	g_iconv_close (serv->read_converter);
 	g_iconv_close (serv->write_converter);
 
 	if (serv->favlist)
 		g_slist_free_full (serv->favlist, (GDestroyNotify) servlist_favchan_free);
 #ifdef USE_OPENSSL
+	ssl_forget_session (serv);
 	if (serv->ctx)
 		_SSL_context_free (serv->ctx);
 
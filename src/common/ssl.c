@@ -95,12 +95,14 @@ _SSL_context_init (void (*info_cb_func))
 	ctx = SSL_CTX_new (TLS_client_method ());
 #endif
 
-	SSL_CTX_set_session_cache_mode (ctx, SSL_SESS_CACHE_BOTH);
+	/* sessions are kept per server by the new session callback (see
+	   server.c) and offered again on reconnect; tickets are allowed so
+	   that resumption works without a session cache on the server */
+	SSL_CTX_set_session_cache_mode (ctx, SSL_SESS_CACHE_CLIENT|SSL_SESS_CACHE_NO_INTERNAL_STORE);
 	SSL_CTX_set_timeout (ctx, 300);
 	SSL_CTX_set_options (ctx, SSL_OP_NO_SSLv2|SSL_OP_NO_SSLv3
 							  |SSL_OP_NO_COMPRESSION
 							  |SSL_OP_SINGLE_DH_USE|SSL_OP_SINGLE_ECDH_USE
-							  |SSL_OP_NO_TICKET
 							  |SSL_OP_CIPHER_SERVER_PREFERENCE);
 
 #if OPENSSL_VERSION_NUMBER >= 0x00908000L && OPENSSL_VERSION_NUMBER < 0x10100000L && !defined (OPENSSL_NO_COMP)
@@ -66,6 +66,7 @@ static ca_context *ca_con;
 #endif
 
 #define SCROLLBACK_MAX 32000
+#define SCROLLBACK_TAIL_LINES 200	/* printed up front by scrollback_load() */
 
 static void mkdir_p (char *filename);
 static char *log_create_filename (char *channame);
@@ -150,7 +151,11 @@ scrollback_shrink (session *sess)
 
 	if (g_file_replace_contents (sess->scrollfile, p, strlen(p), NULL, FALSE,
 							G_FILE_CREATE_PRIVATE, NULL, NULL, NULL))
+	{
 		sess->scrollwritten = lines;
+		/* keep scrollback_load_older() pointing at the same line */
+		sess->scrollback_offset = MAX (0, sess->scrollback_offset - (p - buf));
+	}
 
 	g_free (buf);
 }
@@ -217,15 +222,128 @@ scrollback_save (session *sess, char *text, time_t stamp)
 		scrollback_shrink (sess);
 }
 
+/*
+ * Print one raw scrollback line (without its newline) in the
+ * "T <stamp> text" format written by scrollback_save(). *stamp is updated
+ * for timestamped lines. Returns FALSE if the line was skipped.
+ */
+static gboolean
+scrollback_print_line (session *sess, const char *line, gsize len,
+							  time_t *stamp, gboolean prepend)
+{
+	char *buf, *text, *stripped = NULL;
+	time_t line_stamp = 0;
+
+	/* written on windows */
+	if (len && line[len - 1] == '\r')
+		len--;
+
+	if (!g_utf8_validate (line, len, NULL))
+	{
+		g_warning ("Invalid utf8 in scrollback file");
+		return FALSE;
+	}
+
+	buf = g_strndup (line, len);
+
+	/*
+	 * Some scrollback lines have three blanks after the timestamp and a newline
+	 * Some have only one blank and a newline
+	 * Some don't even have a timestamp
+	 * Some don't have any text at all
+	 */
+	if (buf[0] == 'T' && buf[1] == ' ')
+	{
+		if (sizeof (time_t) == 4)
+			line_stamp = strtoul (buf + 2, NULL, 10);
+		else
+			line_stamp = g_ascii_strtoull (buf + 2, NULL, 10); /* in case time_t is 64 bits */
+
+		if (G_UNLIKELY(line_stamp == 0))
+		{
+			g_warning ("Invalid timestamp in scrollback file");
+			g_free (buf);
+			return FALSE;
+		}
+		*stamp = line_stamp;
+
+		text = strchr (buf + 3, ' ');
+		if (text && text[1])
+		{
+			text++;
+			if (prefs.pchat_text_stripcolor_replay)
+				text = stripped = strip_color (text, -1, STRIP_COLOR);
+		}
+		else
+		{
+			text = "  ";
+		}
+	}
+	else
+	{
+		text = buf[0] ? buf : "  ";
+	}
+
+	if (prepend)
+		fe_prepend_text (sess, text, line_stamp);
+	else
+		fe_print_text (sess, text, line_stamp, TRUE);
+
+	g_free (stripped);
+	g_free (buf);
+
+	return TRUE;
+}
+
+static GMappedFile *
+scrollback_map (session *sess)
+{
+	GMappedFile *map;
+	char *path;
+
+	path = g_file_get_path (sess->scrollfile);
+	if (!path)
+		return NULL;
+
+	map = g_mapped_file_new (path, FALSE, NULL);
+	g_free (path);
+
+	return map;
+}
+
+/* offset of the line starting 'count' lines before 'end' (itself a line start) */
+static gsize
+scrollback_seek_back (const char *data, gsize end, int count)
+{
+	gsize pos = end;
+
+	while (count > 0 && pos > 0)
+	{
+		pos--;	/* step over the previous line's newline */
+		while (pos > 0 && data[pos - 1] != '\n')
+			pos--;
+		count--;
+	}
+
+	return pos;
+}
+
+/*
+ * Only the last SCROLLBACK_TAIL_LINES of the file are printed here, the
+ * rest is paged in by scrollback_load_older() when the user scrolls up.
+ */
 void
 scrollback_load (session *sess)
 {
-	GInputStream *stream;
-	GDataInputStream *istream;
+	GMappedFile *map;
+	const char *data, *p, *end, *eol;
 	gchar *buf, *text;
+	gsize len, start;
 	gint lines = 0;
 	time_t stamp = 0;
 
+	sess->scrollback_offset = 0;
+
 	if (sess->text_scrollback == SET_DEFAULT)
 	{
 		if (!prefs.pchat_text_replay)
@@ -246,100 +364,36 @@ scrollback_load (session *sess)
 		g_free (buf);
 	}
 
-	stream = G_INPUT_STREAM(g_file_read (sess->scrollfile, NULL, NULL));
-	if (!stream)
+	map = scrollback_map (sess);
+	if (!map)
 		return;
 
-	istream = g_data_input_stream_new (stream);
-	/*
-	 * This is to avoid any issues moving between windows/unix
-	 * but the docs mention an invalid \r without a following \n
-	 * can lock up the program... (Our write() always adds \n)
-	 */
-	g_data_input_stream_set_newline_type (istream, G_DATA_STREAM_NEWLINE_TYPE_ANY);
-	g_object_unref (stream);
+	data = g_mapped_file_get_contents (map);
+	len = g_mapped_file_get_length (map);
+	end = data + len;
 
-	while (1)
+	/* count every line for scrollback_save(), but only print the tail */
+	p = data;
+	while (p < end && (p = memchr (p, '\n', end - p)) != NULL)
 	{
-		GError *err = NULL;
-		gsize n_bytes;
-
-		buf = g_data_input_stream_read_line_utf8 (istream, &n_bytes, NULL, &err);
-
-		if (!err && buf)
-		{
-			/*
-			 * Some scrollback lines have three blanks after the timestamp and a newline
-			 * Some have only one blank and a newline
-			 * Some don't even have a timestamp
-			 * Some don't have any text at all
-			 */
-			if (buf[0] == 'T' && buf[1] == ' ')
-			{
-				if (sizeof (time_t) == 4)
-					stamp = strtoul (buf + 2, NULL, 10);
-				else
-					stamp = g_ascii_strtoull (buf + 2, NULL, 10); /* in case time_t is 64 bits */
-
-				if (G_UNLIKELY(stamp == 0))
-				{
-					g_warning ("Invalid timestamp in scrollback file");
-					continue;
-				}
-
-				text = strchr (buf + 3, ' ');
-				if (text && text[1])
-				{
-					if (prefs.pchat_text_stripcolor_replay)
-					{
-						text = strip_color (text + 1, -1, STRIP_COLOR);
-					}
-
-					fe_print_text (sess, text, stamp, TRUE);
-
-					if (prefs.pchat_text_stripcolor_replay)
-					{
-						g_free (text);
-					}
-				}
-				else
-				{
-					fe_print_text (sess, "  ", stamp, TRUE);
-				}
-			}
-			else
-			{
-				if (strlen (buf))
-					fe_print_text (sess, buf, 0, TRUE);
-				else
-					fe_print_text (sess, "  ", 0, TRUE);
-			}
-			lines++;
-
-			g_free (buf);
-		}
-		else if (err)
-		{
-			/* If its only an encoding error it may be specific to the line */
-			if (g_error_matches (err, G_CONVERT_ERROR, G_CONVERT_ERROR_ILLEGAL_SEQUENCE))
-			{
-				g_warning ("Invalid utf8 in scrollback file");
-				g_clear_error (&err);
-				continue;
-			}
+		lines++;
+		p++;
+	}
+	if (len && data[len - 1] != '\n')
+		lines++;
 
-			/* For general errors just give up */
-			g_clear_error (&err);
-			break;
-		}
-		else /* No new line */
-		{
-			break;
-		}
+	start = scrollback_seek_back (data, len, SCROLLBACK_TAIL_LINES);
+	for (p = data + start; p < end; p = eol + 1)
+	{
+		eol = memchr (p, '\n', end - p);
+		if (!eol)
+			eol = end;
+		scrollback_print_line (sess, p, eol - p, &stamp, FALSE);
 	}
 
-	g_object_unref (istream);
+	g_mapped_file_unref (map);
 
+	sess->scrollback_offset = start;
 	sess->scrollwritten = lines;
 
 	if (lines)
@@ -352,6 +406,52 @@ scrollback_load (session *sess)
 	}
 }
 
+/*
+ * Page in up to 'count' lines older than anything replayed so far. They are
+ * handed to the frontend newest first, each one going above the last.
+ * Returns the number of lines printed.
+ */
+int
+scrollback_load_older (session *sess, int count)
+{
+	GMappedFile *map;
+	const char *data, *p, *sol, *eol;
+	gsize start;
+	int lines = 0;
+	time_t stamp = 0;
+
+	if (!sess->scrollfile || sess->scrollback_offset <= 0)
+		return 0;
+
+	map = scrollback_map (sess);
+	if (!map)
+	{
+		sess->scrollback_offset = 0;
+		return 0;
+	}
+
+	data = g_mapped_file_get_contents (map);
+	p = data + MIN ((gsize)sess->scrollback_offset, g_mapped_file_get_length (map));
+	start = scrollback_seek_back (data, p - data, count);
+
+	while (p > data + start)
+	{
+		eol = (p[-1] == '\n') ? p - 1 : p;
+		sol = eol;
+		while (sol > data + start && sol[-1] != '\n')
+			sol--;
+		if (scrollback_print_line (sess, sol, eol - sol, &stamp, TRUE))
+			lines++;
+		p = sol;
+	}
+
+	g_mapped_file_unref (map);
+
+	sess->scrollback_offset = start;
+
+	return lines;
+}
+
 void
 log_close (session *sess)
 {
@@ -1060,6 +1160,19 @@ static char * const pevt_quit_help[] = {
 	N_("Host"),
 };
 
+static char * const pevt_netsplit_help[] = {
+	N_("Servers"),
+	N_("Number of users"),
+	N_("Nicks"),
+};
+
+static char * const pevt_netjoin_help[] = {
+	N_("Servers"),
+	N_("Number of users"),
+	N_("Nicks"),
+	N_("The channel"),
+};
+
 static char * const pevt_pingrep_help[] = {
 	N_("Who it's from"),
 	N_("The time in x.x format (see below)"),
@@ -1610,25 +1723,25 @@ pevent_trigger_load (int *i_penum, char **i_text, char **i_snd)
 	*i_penum = 0;
 }
 
+/* event name -> index + 1, the names in te[] are never freed */
+static GHashTable *pevent_names = NULL;
+
 static int
 pevent_find (char *name, int *i_i)
 {
-	int i = *i_i, j;
+	int i;
 
-	j = i + 1;
-	while (1)
+	if (!pevent_names)
 	{
-		if (j == NUM_XP)
-			j = 0;
-		if (strcmp (te[j].name, name) == 0)
-		{
-			*i_i = j;
-			return j;
-		}
-		if (j == i)
-			return -1;
-		j++;
+		pevent_names = g_hash_table_new (g_str_hash, g_str_equal);
+		for (i = 0; i < NUM_XP; i++)
+			g_hash_table_insert (pevent_names, te[i].name, GINT_TO_POINTER (i + 1));
 	}
+
+	i = GPOINTER_TO_INT (g_hash_table_lookup (pevent_names, name)) - 1;
+	if (i >= 0)
+		*i_i = i;
+	return i;
 }
 
 int
@@ -2079,6 +2192,8 @@ text_emit (int index, session *sess, char *a, char *b, char *c, char *d,
 	case XP_TE_PART:
 	case XP_TE_PARTREASON:
 	case XP_TE_QUIT:
+	case XP_TE_NETJOIN:
+	case XP_TE_NETSPLIT:
 		/* implement ConfMode / Hide Join and Part Messages */
 		if (chanopt_is_set (prefs.pchat_irc_conf_mode, sess->text_hidejoinpart))
 			return;
@@ -39,6 +39,7 @@ struct text_event
 
 void scrollback_close (session *sess);
 void scrollback_load (session *sess);
+int scrollback_load_older (session *sess, int count);
 
 int text_word_check (char *word, int len);
 void PrintText (session *sess, char *text);
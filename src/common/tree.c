@@ -252,3 +252,36 @@ int tree_size (tree *t)
 	return t->elements;
 }
 
+/* position of the first element that doesn't sort before key, so a range
+   of matches can be walked with tree_nth() */
+int
+tree_lower_bound (tree *t, const void *key, tree_cmp_func *cmp, void *data)
+{
+	int l, u, idx;
+
+	if (!t || !t->array)
+		return 0;
+
+	l = 0;
+	u = t->elements;
+	while (l < u)
+	{
+		idx = (l + u) / 2;
+		if (cmp (key, t->array[idx], data) > 0)
+			l = idx + 1;
+		else
+			u = idx;
+	}
+
+	return l;
+}
+
+void *
+tree_nth (tree *t, int pos)
+{
+	if (!t || pos < 0 || pos >= t->elements)
+		return NULL;
+
+	return t->array[pos];
+}
+
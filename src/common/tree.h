@@ -36,5 +36,7 @@ void tree_foreach (tree *t, tree_traverse_func *func, void *data);
 int tree_insert (tree *t, void *key);
 void tree_append (tree* t, void *key);
 int tree_size (tree *t);
+int tree_lower_bound (tree *t, const void *key, tree_cmp_func *cmp, void *data);
+void *tree_nth (tree *t, int pos);
 
 #endif
@@ -29,6 +29,96 @@
 #include "util.h"
 
 
+/* Hostnames, realnames, server names and accounts are shared between all
+ * channels of a server: each distinct string lives once in the server's
+ * pool with a reference count, and struct User only points into it. */
+
+typedef struct
+{
+	guint refs;
+	char str[1];
+} pooled_string;
+
+#define POOLED_STRING(s) ((pooled_string *) ((s) - G_STRUCT_OFFSET (pooled_string, str)))
+
+static char *
+userlist_str_ref (server *serv, const char *str)
+{
+	pooled_string *ps;
+	gsize len;
+
+	if (!str)
+		return NULL;
+
+	if (!serv->user_strings)
+		serv->user_strings = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+
+	ps = g_hash_table_lookup (serv->user_strings, str);
+	if (!ps)
+	{
+		len = strlen (str);
+		ps = g_malloc (G_STRUCT_OFFSET (pooled_string, str) + len + 1);
+		ps->refs = 0;
+		memcpy (ps->str, str, len + 1);
+		g_hash_table_insert (serv->user_strings, ps->str, ps);
+	}
+	ps->refs++;
+
+	return ps->str;
+}
+
+static void
+userlist_str_unref (server *serv, char *str)
+{
+	pooled_string *ps;
+
+	if (!str)
+		return;
+
+	ps = POOLED_STRING (str);
+	if (--ps->refs == 0)
+		g_hash_table_remove (serv->user_strings, str);
+}
+
+/* point *field at the pooled copy of str, dropping the old reference */
+static void
+userlist_str_set (server *serv, char **field, const char *str)
+{
+	char *old = *field;
+
+	*field = userlist_str_ref (serv, str);
+	userlist_str_unref (serv, old);
+}
+
+/* Reports how many distinct strings the pool holds, the bytes they take and
+ * the bytes saved compared to one copy per channel membership. */
+void
+userlist_pool_stats (server *serv, guint *unique, guint *refs, gsize *bytes, gsize *saved)
+{
+	GHashTableIter iter;
+	pooled_string *ps;
+	gsize len;
+
+	*unique = 0;
+	*refs = 0;
+	*bytes = 0;
+	*saved = 0;
+
+	if (!serv->user_strings)
+		return;
+
+	g_hash_table_iter_init (&iter, serv->user_strings);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &ps))
+	{
+		len = strlen (ps->str) + 1;
+		(*unique)++;
+		*refs += ps->refs;
+		*bytes += len;
+		*saved += len * (ps->refs - 1);
+	}
+}
+
+
 int
 nick_cmp_az_ops (struct User *user1, struct User *user2, server *serv)
 {
@@ -136,6 +226,52 @@ userlist_insertname (session *sess, struct User *newuser)
 	return tree_insert (sess->usertree, newuser);
 }
 
+/* Order used by the completion index: nicks are compared folded with
+ * rfc_tolower, so every nick sharing a prefix ends up in one slice of the
+ * array whatever the userlist sort order is. */
+static int
+nick_fold_cmp (const char *a, const char *b)
+{
+	const unsigned char *s1 = (const unsigned char *) a;
+	const unsigned char *s2 = (const unsigned char *) b;
+
+	while (*s1 && rfc_tolower (*s1) == rfc_tolower (*s2))
+	{
+		s1++;
+		s2++;
+	}
+
+	return rfc_tolower (*s1) - rfc_tolower (*s2);
+}
+
+static int
+completion_cmp (struct User *user1, struct User *user2, void *data)
+{
+	int c = nick_fold_cmp (user1->nick, user2->nick);
+
+	/* nicks that only fold together under rfc1459 are still distinct */
+	if (c == 0)
+		c = strcmp (user1->nick, user2->nick);
+	return c;
+}
+
+static void
+userlist_index_add (session *sess, struct User *user)
+{
+	if (!sess->completion_tree)
+		sess->completion_tree = tree_new ((tree_cmp_func *)completion_cmp, NULL);
+
+	tree_insert (sess->completion_tree, user);
+}
+
+static void
+userlist_index_remove (session *sess, struct User *user)
+{
+	int pos;
+
+	tree_remove (sess->completion_tree, user, &pos);
+}
+
 void
 userlist_set_away (struct session *sess, char *nick, unsigned int away)
 {
@@ -165,11 +301,10 @@ userlist_set_account (struct session *sess, char *nick, char *account)
 	{
 		if (strcmp (account, "*") == 0)
 		{
-			g_clear_pointer (&user->account, g_free);
+			userlist_str_set (sess->server, &user->account, NULL);
 		} else if (g_strcmp0 (user->account, account))
 		{
-			g_free (user->account);
-			user->account = g_strdup (account);
+			userlist_str_set (sess->server, &user->account, account);
 		}
 
 		/* gui doesnt currently reflect login status, maybe later
@@ -191,18 +326,14 @@ userlist_add_hostname (struct session *sess, char *nick, char *hostname,
 		{
 			if (prefs.pchat_gui_ulist_show_hosts)
 				do_rehash = TRUE;
-			g_free (user->hostname);
-			user->hostname = g_strdup (hostname);
+			userlist_str_set (sess->server, &user->hostname, hostname);
 		}
 		if (realname && *realname && g_strcmp0 (user->realname, realname) != 0)
-		{
-			g_free (user->realname);
-			user->realname = g_strdup (realname);
-		}
+			userlist_str_set (sess->server, &user->realname, realname);
 		if (!user->servername && servername)
-			user->servername = g_strdup (servername);
+			user->servername = userlist_str_ref (sess->server, servername);
 		if (!user->account && account && strcmp (account, "0") != 0)
-			user->account = g_strdup (account);
+			user->account = userlist_str_ref (sess->server, account);
 		if (away != 0xff)
 		{
 			if (user->away != away)
@@ -220,12 +351,12 @@ userlist_add_hostname (struct session *sess, char *nick, char *hostname,
 }
 
 static int
-free_user (struct User *user, gpointer data)
+free_user (struct User *user, server *serv)
 {
-	g_free (user->realname);
-	g_free (user->hostname);
-	g_free (user->servername);
-	g_free (user->account);
+	userlist_str_unref (serv, user->realname);
+	userlist_str_unref (serv, user->hostname);
+	userlist_str_unref (serv, user->servername);
+	userlist_str_unref (serv, user->account);
 	g_free (user);
 
 	return TRUE;
@@ -234,10 +365,12 @@ free_user (struct User *user, gpointer data)
 void
 userlist_free (session *sess)
 {
-	tree_foreach (sess->usertree, (tree_traverse_func *)free_user, NULL);
+	tree_foreach (sess->usertree, (tree_traverse_func *)free_user, sess->server);
 	tree_destroy (sess->usertree);
+	tree_destroy (sess->completion_tree);
 
 	sess->usertree = NULL;
+	sess->completion_tree = NULL;
 	sess->me = NULL;
 
 	sess->ops = 0;
@@ -272,6 +405,34 @@ userlist_find (struct session *sess, const char *name)
 	return NULL;
 }
 
+static int
+complete_cmp (const char *prefix, struct User *user, void *data)
+{
+	return nick_fold_cmp (prefix, user->nick);
+}
+
+/* Users whose nick starts with prefix (case-insensitive), in alphabetical
+ * order. Only the matching slice of the completion index is visited. */
+GList *
+userlist_complete (session *sess, const char *prefix)
+{
+	GList *list = NULL;
+	struct User *user;
+	int pos, len;
+
+	len = strlen (prefix);
+	pos = tree_lower_bound (sess->completion_tree, prefix,
+									(tree_cmp_func *)complete_cmp, NULL);
+	while ((user = tree_nth (sess->completion_tree, pos++)))
+	{
+		if (rfc_ncasecmp (user->nick, (char *)prefix, len) != 0)
+			break;
+		list = g_list_prepend (list, user);
+	}
+
+	return g_list_reverse (list);
+}
+
 struct User *
 userlist_find_global (struct server *serv, char *name)
 {
@@ -373,10 +534,12 @@ userlist_change (struct session *sess, char *oldname, char *newname)
 	if (user)
 	{
 		tree_remove (sess->usertree, user, &pos);
+		userlist_index_remove (sess, user);
 		fe_userlist_remove (sess, user);
 
 		safe_strcpy (user->nick, newname, NICKLEN);
 
+		userlist_index_add (sess, user);
 		int row = tree_insert (sess->usertree, user);
 		fe_userlist_insert (sess, user, row, FALSE);
 
@@ -399,8 +562,9 @@ userlist_remove (struct session *sess, char *name)
 	return TRUE;
 }
 
-void
-userlist_remove_user (struct session *sess, struct User *user)
+static void
+userlist_remove_user_real (struct session *sess, struct User *user,
+									gboolean update_numbers)
 {
 	int pos;
 	if (user->voice)
@@ -410,19 +574,43 @@ userlist_remove_user (struct session *sess, struct User *user)
 	if (user->hop)
 		sess->hops--;
 	sess->total--;
-	fe_userlist_numbers (sess);
+	if (update_numbers)
+		fe_userlist_numbers (sess);
 	fe_userlist_remove (sess, user);
 
 	if (user == sess->me)
 		sess->me = NULL;
 
 	tree_remove (sess->usertree, user, &pos);
-	free_user (user, NULL);
+	userlist_index_remove (sess, user);
+	free_user (user, sess->server);
 }
 
 void
-userlist_add (struct session *sess, char *name, char *hostname,
-				  char *account, char *realname, const message_tags_data *tags_data)
+userlist_remove_user (struct session *sess, struct User *user)
+{
+	userlist_remove_user_real (sess, user, TRUE);
+}
+
+/* Like userlist_remove(), but leaves the user count display alone so that a
+ * whole batch can be removed before calling fe_userlist_numbers() once. */
+int
+userlist_remove_bulk (struct session *sess, char *name)
+{
+	struct User *user;
+
+	user = userlist_find (sess, name);
+	if (!user)
+		return FALSE;
+
+	userlist_remove_user_real (sess, user, FALSE);
+	return TRUE;
+}
+
+static void
+userlist_add_real (struct session *sess, char *name, char *hostname,
+						 char *account, char *realname,
+						 const message_tags_data *tags_data, gboolean update_numbers)
 {
 	struct User *user;
 	int row, prefix_chars;
@@ -441,8 +629,7 @@ userlist_add (struct session *sess, char *name, char *hostname,
 		user->prefix[0] = name[0];
 
 	/* add it to our linked list */
-	if (hostname)
-		user->hostname = g_strdup (hostname);
+	user->hostname = userlist_str_ref (sess->server, hostname);
 	safe_strcpy (user->nick, name + prefix_chars, NICKLEN);
 	/* is it me? */
 	if (!sess->server->p_cmp (user->nick, sess->server->nick))
@@ -451,9 +638,9 @@ userlist_add (struct session *sess, char *name, char *hostname,
 	if (sess->server->have_extjoin)
 	{
 		if (account && *account)
-			user->account = g_strdup (account);
+			user->account = userlist_str_ref (sess->server, account);
 		if (realname && *realname)
-			user->realname = g_strdup (realname);
+			user->realname = userlist_str_ref (sess->server, realname);
 	}
 
 	row = userlist_insertname (sess, user);
@@ -461,14 +648,12 @@ userlist_add (struct session *sess, char *name, char *hostname,
 	/* duplicate? some broken servers trigger this */
 	if (row == -1)
 	{
-		g_free (user->hostname);
-		g_free (user->account);
-		g_free (user->realname);
-		g_free (user);
+		free_user (user, sess->server);
 		return;
 	}
 
 	sess->total++;
+	userlist_index_add (sess, user);
 
 	/* most ircds don't support multiple modechars in front of the nickname
       for /NAMES - though they should. */
@@ -483,10 +668,27 @@ userlist_add (struct session *sess, char *name, char *hostname,
 		sess->me = user;
 
 	fe_userlist_insert (sess, user, row, FALSE);
-	if(sess->end_of_names)
+	if (update_numbers)
 		fe_userlist_numbers (sess);
 }
 
+void
+userlist_add (struct session *sess, char *name, char *hostname,
+				  char *account, char *realname, const message_tags_data *tags_data)
+{
+	userlist_add_real (sess, name, hostname, account, realname, tags_data,
+							 sess->end_of_names);
+}
+
+/* Like userlist_add(), but the caller refreshes the user count display with
+ * fe_userlist_numbers() once the whole batch is in. */
+void
+userlist_add_bulk (struct session *sess, char *name, char *hostname,
+						 char *account, char *realname, const message_tags_data *tags_data)
+{
+	userlist_add_real (sess, name, hostname, account, realname, tags_data, FALSE);
+}
+
 static int
 rehash_cb (struct User *user, session *sess)
 {
@@ -26,6 +26,7 @@
 struct User
 {
 	char nick[NICKLEN];
+	/* these point into the server's string pool, never free or modify them */
 	char *hostname;
 	char *realname;
 	char *servername;
@@ -50,11 +51,15 @@ void userlist_set_away (session *sess, char *nick, unsigned int away);
 void userlist_set_account (session *sess, char *nick, char *account);
 struct User *userlist_find (session *sess, const char *name);
 struct User *userlist_find_global (server *serv, char *name);
+GList *userlist_complete (session *sess, const char *prefix);
 void userlist_clear (session *sess);
 void userlist_free (session *sess);
 void userlist_add (session *sess, char *name, char *hostname, char *account,
 						 char *realname, const message_tags_data *tags_data);
+void userlist_add_bulk (session *sess, char *name, char *hostname, char *account,
+							 char *realname, const message_tags_data *tags_data);
 int userlist_remove (session *sess, char *name);
+int userlist_remove_bulk (session *sess, char *name);
 void userlist_remove_user (session *sess, struct User *user);
 int userlist_change (session *sess, char *oldname, char *newname);
 void userlist_update_mode (session *sess, char *name, char mode, char sign);
@@ -62,6 +67,8 @@ GSList *userlist_flat_list (session *sess);
 GList *userlist_double_list (session *sess);
 void userlist_rehash (session *sess);
 void userlist_resort (session *sess);
+void userlist_pool_stats (server *serv, guint *unique, guint *refs, gsize *bytes,
+								  gsize *saved);
 int nick_cmp (struct User *user1, struct User *user2, server *serv);
 int nick_cmp_az_ops (struct User *user1, struct User *user2, server *serv);
 int nick_cmp_alpha (struct User *user1, struct User *user2, server *serv);
@@ -46,6 +46,7 @@ static void supports_bans (banlist_info *, int);
 static void supports_exempt (banlist_info *, int);
 static void supports_invite (banlist_info *, int);
 static void supports_quiet (banlist_info *, int);
+static gint64 banlist_date_key (char *when);
 
 static mode_info modes[MODE_CT] = {
 	{
@@ -93,6 +94,7 @@ enum
 	MASK_COLUMN,
 	FROM_COLUMN,
 	DATE_COLUMN,
+	DATE_KEY_COLUMN,	/* DATE_COLUMN as a time_t, for sorting */
 	N_COLUMNS
 };
 
@@ -224,10 +226,10 @@ fe_add_ban_list (struct session *sess, char *mask, char *who, char *when, int rp
 	if (banl->pending & 1<<i)
 	{
 		store = get_store (sess);
-		gtk_list_store_append (store, &iter);
-
-		gtk_list_store_set (store, &iter, TYPE_COLUMN, _(modes[i].type), MASK_COLUMN, mask,
-						FROM_COLUMN, who, DATE_COLUMN, when, -1);
+		gtk_list_store_insert_with_values (store, &iter, -1,
+						TYPE_COLUMN, _(modes[i].type), MASK_COLUMN, mask,
+						FROM_COLUMN, who, DATE_COLUMN, when,
+						DATE_KEY_COLUMN, banlist_date_key (when), -1);
 
 		banl->line_ct++;
 		return TRUE;
@@ -320,6 +322,13 @@ fe_ban_list_end (struct session *sess, int rplcode)
 		banl->pending &= ~modes[i].bit;
 		if (!banl->pending)
 		{
+			/* sort once now that everything is in */
+			if (banl->sort_saved)
+			{
+				gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (get_store (sess)),
+																  banl->sort_id, banl->sort_order);
+				banl->sort_saved = FALSE;
+			}
 			gtk_widget_set_sensitive (banl->but_refresh, TRUE);
 			banlist_sensitize (banl);
 		}
@@ -446,6 +455,18 @@ banlist_do_refresh (banlist_info *banl)
 		gtk_list_store_clear (store);
 		banl->line_ct = 0;
 		banl->pending = banl->checked;
+
+		/* rows are appended unsorted and sorted once at the end, rather
+		   than each reply being moved into place as it arrives */
+		if (banl->pending && !banl->sort_saved &&
+			 gtk_tree_sortable_get_sort_column_id (GTK_TREE_SORTABLE (store),
+															  &banl->sort_id, &banl->sort_order))
+		{
+			banl->sort_saved = TRUE;
+			gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store),
+															  GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID,
+															  GTK_SORT_ASCENDING);
+		}
 		if (banl->pending)
 		{
 			for (i = 0; i < MODE_CT; i++)
@@ -689,19 +710,25 @@ banlist_strptime (char *ti, struct tm *tm)
 	tm->tm_year = y;
 }
 
+/* parsed once per row, as fe_add_ban_list () adds it */
+static gint64
+banlist_date_key (char *when)
+{
+	struct tm tm;
+
+	memset (&tm, 0, sizeof tm);
+	banlist_strptime (when, &tm);
+	tm.tm_isdst = -1;
+	return mktime (&tm);
+}
+
 gint
 banlist_date_sort (GtkTreeModel *model, GtkTreeIter *a, GtkTreeIter *b, gpointer user_data)
 {
-	struct tm tm1, tm2;
-	time_t t1, t2;
-	char *time1, *time2;
+	gint64 t1, t2;
 
-	gtk_tree_model_get(model, a, DATE_COLUMN, &time1, -1);
-	gtk_tree_model_get(model, b, DATE_COLUMN, &time2, -1);
-	banlist_strptime (time1, &tm1);
-	banlist_strptime (time2, &tm2);
-	t1 = mktime (&tm1);
-	t2 = mktime (&tm2);
+	gtk_tree_model_get (model, a, DATE_KEY_COLUMN, &t1, -1);
+	gtk_tree_model_get (model, b, DATE_KEY_COLUMN, &t2, -1);
 
 	if (t1 < t2) return 1;
 	if (t1 == t2) return 0;
@@ -718,7 +745,7 @@ banlist_treeview_new (GtkWidget *box, banlist_info *banl)
 	GtkTreeSortable *sortable;
 
 	store = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING,
-										 G_TYPE_STRING, G_TYPE_STRING);
+										 G_TYPE_STRING, G_TYPE_STRING, G_TYPE_INT64);
 	g_return_val_if_fail (store != NULL, NULL);
 
 	sortable = GTK_TREE_SORTABLE (store);
@@ -56,6 +56,9 @@ typedef struct banlist_info_s {
 	int current;	/* index of currently processing mode */
 	int line_ct;	/* count of presented lines */
 	int select_ct;	/* count of selected lines */
+	int sort_id;	/* sort column put aside while replies arrive */
+	GtkSortType sort_order;
+	gboolean sort_saved;	/* sort_id/sort_order are set */
 	GtkWidget *window;
 	GtkWidget *treeview;
 	GtkWidget *checkboxes[MODE_CT];
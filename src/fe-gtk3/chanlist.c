@@ -71,6 +71,10 @@ chanlistrow;
 
 #define GET_MODEL(xserv) (gtk_tree_view_get_model(GTK_TREE_VIEW(xserv->gui->chanlist_list)))
 
+/* rows are carved out of blocks this big and only freed all together */
+#define CHANLIST_BLOCK_SIZE 65536
+#define CHANLIST_ALIGN(n) (((n) + sizeof (gpointer) - 1) & ~(sizeof (gpointer) - 1))
+
 
 static gboolean
 chanlist_match (server *serv, const char *str)
@@ -78,13 +82,13 @@ chanlist_match (server *serv, const char *str)
 	switch (serv->gui->chanlist_search_type)
 	{
 	case 1:
-		return match (gtk_entry_get_text (GTK_ENTRY (serv->gui->chanlist_wild)), str);
+		return match (serv->gui->chanlist_filter, str);
 	case 2:
 		if (!serv->gui->have_regex)
 			return 0;
 		return g_regex_match (serv->gui->chanlist_match_regex, str, 0, NULL);
 	default:	/* case 0: */
-		return nocasestrstr (str, gtk_entry_get_text (GTK_ENTRY (serv->gui->chanlist_wild))) ? 1 : 0;
+		return nocasestrstr (str, serv->gui->chanlist_filter) ? 1 : 0;
 	}
 }
 
@@ -134,59 +138,84 @@ chanlist_reset_counters (server *serv)
 	chanlist_update_buttons (serv);
 }
 
-/* free up our entire linked list and all the nodes */
+/* take len bytes for a row from the current block, starting a new one if
+   it doesn't fit */
+static void *
+chanlist_alloc (server *serv, gsize len)
+{
+	struct server_gui *gui = serv->gui;
+	gsize start;
+
+	start = CHANLIST_ALIGN (gui->chanlist_block_used);
+	if (!gui->chanlist_blocks || start + len > gui->chanlist_block_size)
+	{
+		gui->chanlist_block_size = MAX (CHANLIST_BLOCK_SIZE, len);
+		gui->chanlist_blocks = g_slist_prepend (gui->chanlist_blocks,
+															 g_malloc (gui->chanlist_block_size));
+		start = 0;
+	}
+
+	gui->chanlist_block_used = start + len;
+	return (char *)gui->chanlist_blocks->data + start;
+}
+
+/* give back the unused end of the last allocation */
+static void
+chanlist_alloc_trim (server *serv, char *end)
+{
+	serv->gui->chanlist_block_used = end - (char *)serv->gui->chanlist_blocks->data;
+}
+
+/* free up all the rows and the blocks they live in */
 
 static void
 chanlist_data_free (server *serv)
 {
-	GSList *rows;
 	chanlistrow *data;
+	guint i;
 
-	if (serv->gui->chanlist_data_stored_rows)
+	if (serv->gui->chanlist_rows)
 	{
-		for (rows = serv->gui->chanlist_data_stored_rows; rows != NULL;
-			  rows = rows->next)
+		for (i = 0; i < serv->gui->chanlist_rows->len; i++)
 		{
-			data = rows->data;
-			g_free (data->topic);
+			data = g_ptr_array_index (serv->gui->chanlist_rows, i);
 			g_free (data->collation_key);
-			g_free (data);
 		}
 
-		g_slist_free (serv->gui->chanlist_data_stored_rows);
-		serv->gui->chanlist_data_stored_rows = NULL;
+		g_ptr_array_free (serv->gui->chanlist_rows, TRUE);
+		serv->gui->chanlist_rows = NULL;
 	}
 
-	g_slist_free (serv->gui->chanlist_pending_rows);
-	serv->gui->chanlist_pending_rows = NULL;
+	g_slist_free_full (serv->gui->chanlist_blocks, g_free);
+	serv->gui->chanlist_blocks = NULL;
+	serv->gui->chanlist_block_used = 0;
+	serv->gui->chanlist_block_size = 0;
+
+	if (serv->gui->chanlist_pending_rows)
+		g_ptr_array_set_size (serv->gui->chanlist_pending_rows, 0);
 }
 
-/* add any rows we received from the server in the last 0.25s to the GUI */
+/* add any rows we received from the server in the last 0.25s to the GUI,
+   merging them into the current sort order */
 
 static void
 chanlist_flush_pending (server *serv)
 {
-	GSList *list = serv->gui->chanlist_pending_rows;
-	GtkTreeModel *model;
-	chanlistrow *row;
+	GPtrArray *pending = serv->gui->chanlist_pending_rows;
+	CustomList *model;
 
-	if (!list)
+	if (!pending || pending->len == 0)
 	{
 		if (serv->gui->chanlist_caption_is_stale)
 			chanlist_update_caption (serv);
 		return;
 	}
-	model = GET_MODEL (serv);
+	model = CUSTOM_LIST (GET_MODEL (serv));
 
-	while (list)
-	{
-		row = list->data;
-		custom_list_append (CUSTOM_LIST (model), row);
-		list = list->next;
-	}
+	custom_list_append_rows (model, (chanlistrow **)pending->pdata, pending->len);
+	custom_list_resort (model);
 
-	g_slist_free (serv->gui->chanlist_pending_rows);
-	serv->gui->chanlist_pending_rows = NULL;
+	g_ptr_array_set_size (pending, 0);
 	chanlist_update_caption (serv);
 }
 
@@ -198,36 +227,30 @@ chanlist_timeout (server *serv)
 }
 
 /**
- * Places a data row into the gui GtkTreeView, if and only if the row matches
- * the user and regex/search requirements.
+ * Counts a data row and returns whether it matches the user and
+ * regex/search requirements, i.e. whether it should be shown.
  */
-static void
-chanlist_place_row_in_gui (server *serv, chanlistrow *next_row, gboolean force)
+static gboolean
+chanlist_filter_row (server *serv, chanlistrow *next_row)
 {
-	GtkTreeModel *model;
-
 	/* First, update the 'found' counter values */
 	serv->gui->chanlist_users_found_count += next_row->users;
 	serv->gui->chanlist_channels_found_count++;
 
-	if (serv->gui->chanlist_channels_shown_count == 1)
-		/* join & save buttons become live */
-		chanlist_update_buttons (serv);
-
 	if (next_row->users < serv->gui->chanlist_minusers)
 	{
 		serv->gui->chanlist_caption_is_stale = TRUE;
-		return;
+		return FALSE;
 	}
 
 	if (next_row->users > serv->gui->chanlist_maxusers
 		 && serv->gui->chanlist_maxusers > 0)
 	{
 		serv->gui->chanlist_caption_is_stale = TRUE;
-		return;
+		return FALSE;
 	}
 
-	if (gtk_entry_get_text (GTK_ENTRY (serv->gui->chanlist_wild))[0])
+	if (serv->gui->chanlist_filter[0])
 	{
 		/* Check what the user wants to match. If both buttons or _neither_
 		 * button is checked, look for match in both by default.
@@ -239,7 +262,7 @@ chanlist_place_row_in_gui (server *serv, chanlistrow *next_row, gboolean force)
 				 && !chanlist_match (serv, next_row->topic))
 			{
 				serv->gui->chanlist_caption_is_stale = TRUE;
-				return;
+				return FALSE;
 			}
 		}
 
@@ -248,7 +271,7 @@ chanlist_place_row_in_gui (server *serv, chanlistrow *next_row, gboolean force)
 			if (!chanlist_match (serv, GET_CHAN (next_row)))
 			{
 				serv->gui->chanlist_caption_is_stale = TRUE;
-				return;
+				return FALSE;
 			}
 		}
 
@@ -257,12 +280,35 @@ chanlist_place_row_in_gui (server *serv, chanlistrow *next_row, gboolean force)
 			if (!chanlist_match (serv, next_row->topic))
 			{
 				serv->gui->chanlist_caption_is_stale = TRUE;
-				return;
+				return FALSE;
 			}
 		}
 	}
 
-	if (force || serv->gui->chanlist_channels_shown_count < 20)
+	/* Update the 'shown' counter values */
+	serv->gui->chanlist_users_shown_count += next_row->users;
+	serv->gui->chanlist_channels_shown_count++;
+
+	return TRUE;
+}
+
+/**
+ * Places a freshly received row into the gui GtkTreeView, if and only if
+ * the row matches the user and regex/search requirements.
+ */
+static void
+chanlist_place_row_in_gui (server *serv, chanlistrow *next_row)
+{
+	GtkTreeModel *model;
+
+	if (serv->gui->chanlist_channels_shown_count == 1)
+		/* join & save buttons become live */
+		chanlist_update_buttons (serv);
+
+	if (!chanlist_filter_row (serv, next_row))
+		return;
+
+	if (serv->gui->chanlist_channels_shown_count <= 20)
 	{
 		model = GET_MODEL (serv);
 		/* makes it appear fast :) */
@@ -270,12 +316,12 @@ chanlist_place_row_in_gui (server *serv, chanlistrow *next_row, gboolean force)
 		chanlist_update_caption (serv);
 	}
 	else
+	{
 		/* add it to GUI at the next update interval */
-		serv->gui->chanlist_pending_rows = g_slist_prepend (serv->gui->chanlist_pending_rows, next_row);
-
-	/* Update the 'shown' counter values */
-	serv->gui->chanlist_users_shown_count += next_row->users;
-	serv->gui->chanlist_channels_shown_count++;
+		if (!serv->gui->chanlist_pending_rows)
+			serv->gui->chanlist_pending_rows = g_ptr_array_new ();
+		g_ptr_array_add (serv->gui->chanlist_pending_rows, next_row);
+	}
 }
 
 /* Performs the LIST download from the IRC server. */
@@ -327,65 +373,85 @@ chanlist_refresh (GtkWidget * wid, server *serv)
 }
 
 /**
- * Fills the gui GtkTreeView with stored items from the GSList.
+ * Fills the gui GtkTreeView with the stored rows that pass the filters.
  */
 static void
 chanlist_build_gui_list (server *serv)
 {
-	GSList *rows;
+	GtkWidget *view = serv->gui->chanlist_list;
+	GtkTreeModel *model;
+	GPtrArray *shown;
+	chanlistrow *row;
+	guint i;
 
 	/* first check if the list is present */
-	if (serv->gui->chanlist_data_stored_rows == NULL)
+	if (serv->gui->chanlist_rows == NULL)
 	{
 		/* start a download */
 		chanlist_do_refresh (serv);
 		return;
 	}
 
-	custom_list_clear ((CustomList *)GET_MODEL (serv));
-
-	/* discard pending rows FIXME: free the structs? */
-	g_slist_free (serv->gui->chanlist_pending_rows);
-	serv->gui->chanlist_pending_rows = NULL;
+	/* the pending rows are all in chanlist_rows too */
+	if (serv->gui->chanlist_pending_rows)
+		g_ptr_array_set_size (serv->gui->chanlist_pending_rows, 0);
 
 	/* Reset the counters */
 	chanlist_reset_counters (serv);
 
-	/* Refill the list */
-	for (rows = serv->gui->chanlist_data_stored_rows; rows != NULL;
-		  rows = rows->next)
+	/* work out the new contents first, without touching the GUI */
+	shown = g_ptr_array_sized_new (serv->gui->chanlist_rows->len);
+	for (i = 0; i < serv->gui->chanlist_rows->len; i++)
 	{
-		chanlist_place_row_in_gui (serv, rows->data, TRUE);
+		row = g_ptr_array_index (serv->gui->chanlist_rows, i);
+		if (chanlist_filter_row (serv, row))
+			g_ptr_array_add (shown, row);
 	}
 
-	custom_list_resort ((CustomList *)GET_MODEL (serv));
+	/* then swap them in with the view detached, so it sees one new model
+	   instead of a signal for every removed and added row */
+	model = g_object_ref (GET_MODEL (serv));
+	gtk_tree_view_set_model (GTK_TREE_VIEW (view), NULL);
+
+	custom_list_clear (CUSTOM_LIST (model));
+	custom_list_append_rows (CUSTOM_LIST (model), (chanlistrow **)shown->pdata, shown->len);
+	custom_list_resort (CUSTOM_LIST (model));
+
+	gtk_tree_view_set_model (GTK_TREE_VIEW (view), model);
+	g_object_unref (model);
+	g_ptr_array_free (shown, TRUE);
+
+	chanlist_update_caption (serv);
+	chanlist_update_buttons (serv);
 }
 
 /**
- * Accepts incoming channel data from inbound.c, allocates new space for a
- * chanlistrow, adds it to our linked list and calls chanlist_place_row_in_gui.
+ * Accepts incoming channel data from inbound.c, stores it as a chanlistrow
+ * and calls chanlist_place_row_in_gui.
  */
 void
 fe_add_chan_list (server *serv, char *chan, char *users, char *topic)
 {
 	chanlistrow *next_row;
 	int len = strlen (chan) + 1;
-
-	/* we allocate the struct and channel string in one go */
-	next_row = g_malloc (sizeof (chanlistrow) + len);
-	memcpy (((char *)next_row) + sizeof (chanlistrow), chan, len);
-	next_row->topic = strip_color (topic, -1, STRIP_ALL);
-	next_row->collation_key = g_utf8_collate_key (chan, len-1);
-	if (!(next_row->collation_key))
-		next_row->collation_key = g_strdup (chan);
+	int topic_len = strlen (topic);
+
+	/* the struct, channel and stripped topic share one piece of a block */
+	next_row = chanlist_alloc (serv, sizeof (chanlistrow) + len + topic_len + 1);
+	memcpy (GET_CHAN (next_row), chan, len);
+	next_row->topic = GET_CHAN (next_row) + len;
+	topic_len = strip_color2 (topic, topic_len, next_row->topic, STRIP_ALL);
+	chanlist_alloc_trim (serv, next_row->topic + topic_len + 1);
+	next_row->collation_key = NULL;
 	next_row->users = atoi (users);
 
 	/* add this row to the data */
-	serv->gui->chanlist_data_stored_rows =
-		g_slist_prepend (serv->gui->chanlist_data_stored_rows, next_row);
+	if (!serv->gui->chanlist_rows)
+		serv->gui->chanlist_rows = g_ptr_array_new ();
+	g_ptr_array_add (serv->gui->chanlist_rows, next_row);
 
 	/* _possibly_ add the row to the gui */
-	chanlist_place_row_in_gui (serv, next_row, FALSE);
+	chanlist_place_row_in_gui (serv, next_row);
 }
 
 void
@@ -408,6 +474,10 @@ chanlist_find_cb (GtkWidget * wid, server *serv)
 {
 	const char *pattern = gtk_entry_get_text (GTK_ENTRY (wid));
 
+	/* keep a copy so filtering rows doesn't have to ask the entry each time */
+	g_free (serv->gui->chanlist_filter);
+	serv->gui->chanlist_filter = g_strdup (pattern);
+
 	/* recompile the regular expression. */
 	if (serv->gui->have_regex)
 	{
@@ -643,6 +713,15 @@ chanlist_destroy_widget (GtkWidget *wid, server *serv)
 	custom_list_clear ((CustomList *)GET_MODEL (serv));
 	chanlist_data_free (serv);
 
+	if (serv->gui->chanlist_pending_rows)
+	{
+		g_ptr_array_free (serv->gui->chanlist_pending_rows, TRUE);
+		serv->gui->chanlist_pending_rows = NULL;
+	}
+
+	g_free (serv->gui->chanlist_filter);
+	serv->gui->chanlist_filter = NULL;
+
 	if (serv->gui->chanlist_flash_tag)
 	{
 		g_source_remove (serv->gui->chanlist_flash_tag);
@@ -718,7 +797,10 @@ chanlist_opengui (server *serv, int do_refresh)
 	serv->gui->chanlist_pending_rows = NULL;
 	serv->gui->chanlist_tag = 0;
 	serv->gui->chanlist_flash_tag = 0;
-	serv->gui->chanlist_data_stored_rows = NULL;
+	serv->gui->chanlist_rows = NULL;
+	serv->gui->chanlist_blocks = NULL;
+	serv->gui->chanlist_block_used = 0;
+	serv->gui->chanlist_block_size = 0;
 
 	if (!serv->gui->chanlist_minusers)
 	{
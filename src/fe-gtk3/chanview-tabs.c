@@ -368,16 +368,58 @@ cv_tabs_postinit (chanview *cv)
 {
 }
 
+/* each family box keeps its tag-0 tabs, in box order, in a GPtrArray
+ * ("sorted") so that sorted insertion is a binary search instead of a
+ * compare against every tab. it's rebuilt lazily from the box's children
+ * whenever something reorders the box behind our back. */
+
+static GPtrArray *
+tab_sorted_index (GtkWidget *box)
+{
+	GPtrArray *index;
+	GList *children, *list;
+	chan *ch;
+
+	index = g_object_get_data (G_OBJECT (box), "sorted");
+	if (index)
+		return index;
+
+	index = g_ptr_array_new ();
+	children = gtk_container_get_children (GTK_CONTAINER (box));
+	for (list = children; list; list = list->next)
+	{
+		if (GTK_IS_SEPARATOR (list->data))
+			continue;
+		ch = g_object_get_data (G_OBJECT (list->data), "c");
+		if (ch && ch->tag == 0)
+			g_ptr_array_add (index, list->data);
+	}
+	g_list_free (children);
+
+	g_object_set_data_full (G_OBJECT (box), "sorted", index,
+									(GDestroyNotify) g_ptr_array_unref);
+	return index;
+}
+
+static void
+tab_sorted_index_drop (GtkWidget *box)
+{
+	g_object_set_data (G_OBJECT (box), "sorted", NULL);
+}
+
 static void
 tab_add_sorted (chanview *cv, GtkWidget *box, GtkWidget *tab, chan *ch)
 {
-	GList *list;
-	GtkWidget *child;
-	int i = 0;
-	void *b;
+	GPtrArray *index;
+	guint lo, hi, mid;
+	int pos;
+	void *a, *b;
 
-	if (!cv->sorted)
+	if (!cv->sorted || ch->tag != 0)
 	{
+		/* an unsorted insert leaves the index without this tab */
+		if (!cv->sorted)
+			tab_sorted_index_drop (box);
 		gtk_box_pack_start (GTK_BOX (box), tab, 0, 0, 0);
 		gtk_widget_show (tab);
 		return;
@@ -389,30 +431,56 @@ tab_add_sorted (chanview *cv, GtkWidget *box, GtkWidget *tab, chan *ch)
 	/* userdata, passed to mg_tabs_compare() */
 	b = ch->userdata;
 
-	list = gtk_container_get_children (GTK_CONTAINER (box));
-	while (list)
+	/* find the first tab that sorts after this one */
+	index = tab_sorted_index (box);
+	lo = 0;
+	hi = index->len;
+	while (lo < hi)
 	{
-		child = list->data;
-		if (!GTK_IS_SEPARATOR (child))
-		{
-			void *a = g_object_get_data (G_OBJECT (child), "u");
-
-			if (ch->tag == 0 && cv->cb_compare (a, b) > 0)
-			{
-				gtk_box_pack_start (GTK_BOX (box), tab, 0, 0, 0);
-				gtk_box_reorder_child (GTK_BOX (box), tab, ++i);
-				gtk_widget_show (tab);
-				return;
-			}
-		}
-		i++;
-		list = list->next;
+		mid = lo + (hi - lo) / 2;
+		a = g_object_get_data (G_OBJECT (g_ptr_array_index (index, mid)), "u");
+		if (cv->cb_compare (a, b) > 0)
+			hi = mid;
+		else
+			lo = mid + 1;
 	}
 
-	/* append */
 	gtk_box_pack_start (GTK_BOX (box), tab, 0, 0, 0);
-	gtk_box_reorder_child (GTK_BOX (box), tab, i);
+	if (lo < index->len)
+	{
+		gtk_container_child_get (GTK_CONTAINER (box), g_ptr_array_index (index, lo),
+										 "position", &pos, NULL);
+		gtk_box_reorder_child (GTK_BOX (box), tab, pos);
+	}
 	gtk_widget_show (tab);
+
+	/* g_ptr_array_insert() needs glib 2.40 */
+	g_ptr_array_add (index, NULL);
+	memmove (&index->pdata[lo + 1], &index->pdata[lo],
+				(index->len - lo - 1) * sizeof (gpointer));
+	index->pdata[lo] = tab;
+}
+
+/* check if the box is empty (except a vseperator) */
+
+static gboolean
+tab_box_is_empty (GtkWidget *box)
+{
+	GList *children, *list;
+	gboolean empty = TRUE;
+
+	children = gtk_container_get_children (GTK_CONTAINER (box));
+	for (list = children; list; list = list->next)
+	{
+		if (!GTK_IS_SEPARATOR ((GtkWidget *)list->data))
+		{
+			empty = FALSE;
+			break;
+		}
+	}
+	g_list_free (children);
+
+	return empty;
 }
 
 /* remove empty boxes and separators */
@@ -420,78 +488,44 @@ tab_add_sorted (chanview *cv, GtkWidget *box, GtkWidget *tab, chan *ch)
 static void
 cv_tabs_prune (chanview *cv)
 {
-	GList *boxes, *children;
-	GtkWidget *box, *inner;
-	GtkWidget *child;
-	int empty;
+	GList *boxes, *list;
+	GtkWidget *inner;
 
 	inner = ((tabview *)cv)->inner;
 	boxes = gtk_container_get_children (GTK_CONTAINER (inner));
-	while (boxes)
+	for (list = boxes; list; list = list->next)
 	{
-		child = boxes->data;
-		box = child;
-		boxes = boxes->next;
-
-		/* check if the box is empty (except a vseperator) */
-		empty = TRUE;
-		children = gtk_container_get_children (GTK_CONTAINER (box));
-		while (children)
-		{
-			if (!GTK_IS_SEPARATOR ((GtkWidget *)children->data))
-			{
-				empty = FALSE;
-				break;
-			}
-			children = children->next;
-		}
-
-		if (empty)
-			gtk_widget_destroy (box);
+		if (tab_box_is_empty (list->data))
+			gtk_widget_destroy (list->data);
 	}
+	g_list_free (boxes);
 }
 
 static void
 tab_add_real (chanview *cv, GtkWidget *tab, chan *ch)
 {
-	GList *boxes, *children;
+	GList *boxes, *list;
 	GtkWidget *sep, *box, *inner;
-	GtkWidget *child;
-	int empty;
 
 	inner = ((tabview *)cv)->inner;
 	/* see if a family for this tab already exists */
 	boxes = gtk_container_get_children (GTK_CONTAINER (inner));
-	while (boxes)
+	for (list = boxes; list; list = list->next)
 	{
-		child = boxes->data;
-		box = child;
+		box = list->data;
 
 		if (g_object_get_data (G_OBJECT (box), "f") == ch->family)
 		{
+			g_list_free (boxes);
 			tab_add_sorted (cv, box, tab, ch);
 			gtk_widget_queue_resize (gtk_widget_get_parent(inner));
 			return;
 		}
 
-		boxes = boxes->next;
-
-		/* check if the box is empty (except a vseperator) */
-		empty = TRUE;
-		children = gtk_container_get_children (GTK_CONTAINER (box));
-		while (children)
-		{
-			if (!GTK_IS_SEPARATOR ((GtkWidget *)children->data))
-			{
-				empty = FALSE;
-				break;
-			}
-			children = children->next;
-		}
-
-		if (empty)
+		if (tab_box_is_empty (box))
 			gtk_widget_destroy (box);
 	}
+	g_list_free (boxes);
 
 	/* create a new family box */
 	if (cv->vertical)
@@ -738,6 +772,12 @@ cv_tabs_move_focus (chanview *cv, gboolean relative, int num)
 static void
 cv_tabs_remove (chan *ch)
 {
+	GPtrArray *index;
+
+	index = g_object_get_data (G_OBJECT (gtk_widget_get_parent (ch->impl)), "sorted");
+	if (index)
+		g_ptr_array_remove (index, ch->impl);
+
 	gtk_widget_destroy (ch->impl);
 	ch->impl = NULL;
 
@@ -749,10 +789,11 @@ cv_tabs_move (chan *ch, int delta)
 {
 	int i = 0;
 	int pos = 0;
-	GList *list;
+	GList *children, *list;
 	GtkWidget *parent = gtk_widget_get_parent(GTK_WIDGET (ch->impl));
 
-	for (list = gtk_container_get_children (GTK_CONTAINER (parent)); list; list = list->next)
+	children = gtk_container_get_children (GTK_CONTAINER (parent));
+	for (list = children; list; list = list->next)
 	{
 		GtkWidget *child_entry;
 
@@ -766,21 +807,24 @@ cv_tabs_move (chan *ch, int delta)
 		else
 			i++;
 	}
+	g_list_free (children);
 
 	pos = (pos - delta) % i;
 	gtk_box_reorder_child (GTK_BOX (parent), ch->impl, pos);
+	tab_sorted_index_drop (parent);
 }
 
 static void
 cv_tabs_move_family (chan *ch, int delta)
 {
 	int i, pos = 0;
-	GList *list;
+	GList *boxes, *list;
 	GtkWidget *box = NULL;
 
 	/* find position of tab's family */
 	i = 0;
-	for (list = gtk_container_get_children (GTK_CONTAINER (((tabview *)ch->cv)->inner)); list; list = list->next)
+	boxes = gtk_container_get_children (GTK_CONTAINER (((tabview *)ch->cv)->inner));
+	for (list = boxes; list; list = list->next)
 	{
 		GtkWidget *child_entry;
 		void *fam;
@@ -794,6 +838,7 @@ cv_tabs_move_family (chan *ch, int delta)
 		}
 		i++;
 	}
+	g_list_free (boxes);
 
 	pos = (pos - delta) % i;
 	gtk_box_reorder_child (GTK_BOX (gtk_widget_get_parent(box)), box, pos);
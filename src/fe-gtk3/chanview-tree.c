@@ -302,6 +302,15 @@ move_row (chan *ch, int delta, GtkTreeIter *parent)
 	GtkTreeIter *src = &ch->iter;
 	GtkTreeIter dest = ch->iter;
 	GtkTreePath *dest_path;
+	GtkTreeIter up;
+	chan *up_ch;
+
+	/* the siblings' sorted order no longer holds */
+	if (gtk_tree_model_iter_parent (GTK_TREE_MODEL (store), &up, &ch->iter))
+	{
+		gtk_tree_model_get (GTK_TREE_MODEL (store), &up, COL_CHAN, &up_ch, -1);
+		chan_drop_sorted_kids (up_ch);
+	}
 
 	if (delta < 0) /* down */
 	{
@@ -88,10 +88,12 @@ struct _chan
 	GdkPixbuf *icon;
 	short allow_closure;	/* allow it to be closed when it still has children? */
 	short tag;
+	GPtrArray *kids;	/* tag-0 children in store order, or NULL until needed */
 };
 
 static chan *cv_find_chan_by_number (chanview *cv, int num);
 static int cv_find_number_of_chan (chanview *cv, chan *find_ch);
+static void chan_drop_sorted_kids (chan *ch);
 
 
 /* ======= TABS ======= */
@@ -234,6 +236,7 @@ chanview_free_ch (chanview *cv, GtkTreeIter *iter)
 	chan *ch;
 
 	gtk_tree_model_get (GTK_TREE_MODEL (cv->store), iter, COL_CHAN, &ch, -1);
+	chan_drop_sorted_kids (ch);
 	free (ch);
 }
 
@@ -304,29 +307,83 @@ chanview_set_callbacks (chanview *cv,
 	cv->cb_compare = cb_compare;
 }
 
-/* find a place to insert this new entry, based on the compare function */
+/* the children of a parent row that take part in sorting, in store order.
+ * built on first use and kept up to date by chanview_insert_sorted() and
+ * chan_remove(); anything else that reorders them just drops the array. */
 
-static void
-chanview_insert_sorted (chanview *cv, GtkTreeIter *add_iter, GtkTreeIter *parent, void *ud)
+static GPtrArray *
+chanview_sorted_kids (chanview *cv, GtkTreeIter *parent, chan *parent_ch)
 {
 	GtkTreeIter iter;
 	chan *ch;
 
-	if (cv->sorted && gtk_tree_model_iter_children (GTK_TREE_MODEL (cv->store), &iter, parent))
+	if (parent_ch->kids)
+		return parent_ch->kids;
+
+	parent_ch->kids = g_ptr_array_new ();
+	if (gtk_tree_model_iter_children (GTK_TREE_MODEL (cv->store), &iter, parent))
 	{
 		do
 		{
 			gtk_tree_model_get (GTK_TREE_MODEL (cv->store), &iter, COL_CHAN, &ch, -1);
-			if (ch->tag == 0 && cv->cb_compare (ch->userdata, ud) > 0)
-			{
-				gtk_tree_store_insert_before (cv->store, add_iter, parent, &iter);
-				return;
-			}
+			if (ch->tag == 0)
+				g_ptr_array_add (parent_ch->kids, ch);
 		}
 		while (gtk_tree_model_iter_next (GTK_TREE_MODEL (cv->store), &iter));
 	}
 
-	gtk_tree_store_append (cv->store, add_iter, parent);
+	return parent_ch->kids;
+}
+
+/* find a place to insert this new entry, based on the compare function */
+
+static void
+chanview_insert_sorted (chanview *cv, GtkTreeIter *add_iter, GtkTreeIter *parent, chan *ch)
+{
+	GPtrArray *kids;
+	chan *parent_ch, *kid;
+	guint lo, hi, mid;
+
+	gtk_tree_model_get (GTK_TREE_MODEL (cv->store), parent, COL_CHAN, &parent_ch, -1);
+
+	if (!cv->sorted)
+	{
+		chan_drop_sorted_kids (parent_ch);
+		gtk_tree_store_append (cv->store, add_iter, parent);
+		return;
+	}
+
+	/* binary search for the first child that sorts after this one */
+	kids = chanview_sorted_kids (cv, parent, parent_ch);
+	lo = 0;
+	hi = kids->len;
+	while (lo < hi)
+	{
+		mid = lo + (hi - lo) / 2;
+		kid = g_ptr_array_index (kids, mid);
+		if (cv->cb_compare (kid->userdata, ch->userdata) > 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	if (lo < kids->len)
+	{
+		kid = g_ptr_array_index (kids, lo);
+		gtk_tree_store_insert_before (cv->store, add_iter, parent, &kid->iter);
+	} else
+	{
+		gtk_tree_store_append (cv->store, add_iter, parent);
+	}
+
+	if (ch->tag == 0)
+	{
+		/* g_ptr_array_insert() needs glib 2.40 */
+		g_ptr_array_add (kids, NULL);
+		memmove (&kids->pdata[lo + 1], &kids->pdata[lo],
+					(kids->len - lo - 1) * sizeof (gpointer));
+		kids->pdata[lo] = ch;
+	}
 }
 
 /* find a parent node with the same "family" pointer (i.e. the Server tab) */
@@ -362,15 +419,6 @@ chanview_add_real (chanview *cv, char *name, void *family, void *userdata,
 	GtkTreeIter iter;
 	gboolean has_parent = FALSE;
 
-	if (chanview_find_parent (cv, family, &parent_iter, avoid))
-	{
-		chanview_insert_sorted (cv, &iter, &parent_iter, userdata);
-		has_parent = TRUE;
-	} else
-	{
-		gtk_tree_store_append (cv->store, &iter, NULL);
-	}
-
 	if (!ch)
 	{
 		ch = calloc (1, sizeof (chan));
@@ -381,6 +429,16 @@ chanview_add_real (chanview *cv, char *name, void *family, void *userdata,
 		ch->tag = tag;
 		ch->icon = icon;
 	}
+
+	if (chanview_find_parent (cv, family, &parent_iter, avoid))
+	{
+		chanview_insert_sorted (cv, &iter, &parent_iter, ch);
+		has_parent = TRUE;
+	} else
+	{
+		gtk_tree_store_append (cv->store, &iter, NULL);
+	}
+
 	memcpy (&(ch->iter), &iter, sizeof (iter));
 
 	gtk_tree_store_set (cv->store, &iter, COL_NAME, name, COL_CHAN, ch,
@@ -500,6 +558,18 @@ chan_rename (chan *ch, char *name, int trunc_len)
 		free (new_name);
 }
 
+/* forget a parent's sorted children, e.g. after they were reordered */
+
+static void
+chan_drop_sorted_kids (chan *ch)
+{
+	if (ch->kids)
+	{
+		g_ptr_array_free (ch->kids, TRUE);
+		ch->kids = NULL;
+	}
+}
+
 /* this thing is overly complicated */
 
 static int
@@ -584,6 +654,9 @@ chan_emancipate_children (chan *ch)
 	GtkTreeIter childiter;
 	PangoAttrList *attr;
 
+	/* the children are all about to move elsewhere */
+	chan_drop_sorted_kids (ch);
+
 	while (gtk_tree_model_iter_children (GTK_TREE_MODEL (ch->cv->store), &childiter, &ch->iter))
 	{
 		/* remove and re-add all the children, but avoid using "ch" as parent */
@@ -605,7 +678,8 @@ chan_emancipate_children (chan *ch)
 gboolean
 chan_remove (chan *ch, gboolean force)
 {
-	chan *new_ch;
+	chan *new_ch, *parent_ch;
+	GtkTreeIter parent;
 	int i, num;
 	extern int pchat_is_quitting;
 
@@ -648,8 +722,16 @@ chan_remove (chan *ch, gboolean force)
 		}
 	}
 
+	if (gtk_tree_model_iter_parent (GTK_TREE_MODEL (ch->cv->store), &parent, &ch->iter))
+	{
+		gtk_tree_model_get (GTK_TREE_MODEL (ch->cv->store), &parent, COL_CHAN, &parent_ch, -1);
+		if (parent_ch->kids)
+			g_ptr_array_remove (parent_ch->kids, ch);
+	}
+
 	ch->cv->size--;
 	gtk_tree_store_remove (ch->cv->store, &ch->iter);
+	chan_drop_sorted_kids (ch);
 	free (ch);
 	return TRUE;
 }
@@ -251,6 +251,7 @@ custom_list_init (CustomList * custom_list)
 
 	custom_list->num_rows = 0;
 	custom_list->num_alloc = 0;
+	custom_list->num_sorted = 0;
 	custom_list->rows = NULL;
 
 	custom_list->sort_id = SORT_ID_CHANNEL;
@@ -588,6 +589,7 @@ custom_list_sortable_set_sort_column_id (GtkTreeSortable * sortable,
 
 	custom_list->sort_id = sort_col_id;
 	custom_list->sort_order = order;
+	custom_list->num_sorted = 0;
 
 	custom_list_resort (custom_list);
 
@@ -669,6 +671,61 @@ custom_list_qsort_compare_func (chanlistrow ** a, chanlistrow ** b,
 	return strcmp ((*a)->collation_key, (*b)->collation_key);
 }
 
+/* collation keys are only needed when sorting by name, so they're made
+   here rather than for every row that arrives */
+static void
+custom_list_make_keys (CustomList * custom_list, guint start)
+{
+	chanlistrow *row;
+	guint i;
+
+	for (i = start; i < custom_list->num_rows; i++)
+	{
+		row = custom_list->rows[i];
+		if (row->collation_key)
+			continue;
+		row->collation_key = g_utf8_collate_key (GET_CHAN (row), -1);
+		if (!row->collation_key)
+			row->collation_key = g_strdup (GET_CHAN (row));
+	}
+}
+
+/* merge the sorted tail rows[num_sorted..num_rows) into the sorted head */
+static void
+custom_list_merge_tail (CustomList * custom_list)
+{
+	chanlistrow **merged;
+	guint i, j, k, mid, n;
+
+	mid = custom_list->num_sorted;
+	n = custom_list->num_rows;
+
+	/* already in order, e.g. the new rows all sort after the old ones */
+	if (custom_list_qsort_compare_func (&custom_list->rows[mid - 1],
+													&custom_list->rows[mid], custom_list) <= 0)
+		return;
+
+	merged = g_new (chanlistrow *, n);
+	i = 0;
+	j = mid;
+	k = 0;
+	while (i < mid && j < n)
+	{
+		if (custom_list_qsort_compare_func (&custom_list->rows[j],
+														&custom_list->rows[i], custom_list) < 0)
+			merged[k++] = custom_list->rows[j++];
+		else
+			merged[k++] = custom_list->rows[i++];
+	}
+	while (i < mid)
+		merged[k++] = custom_list->rows[i++];
+	while (j < n)
+		merged[k++] = custom_list->rows[j++];
+
+	memcpy (custom_list->rows, merged, n * sizeof (chanlistrow *));
+	g_free (merged);
+}
+
 /*****************************************************************************
  *
  *  custom_list_new:  This is what you use in your own code to create a
@@ -692,12 +749,12 @@ custom_list_append (CustomList * custom_list, chanlistrow * newrecord)
 
 	if (custom_list->num_rows >= custom_list->num_alloc)
 	{
-		custom_list->num_alloc += 64;
+		custom_list->num_alloc = MAX (64, custom_list->num_alloc * 2);
 		newsize = custom_list->num_alloc * sizeof (chanlistrow *);
 		custom_list->rows = g_realloc (custom_list->rows, newsize);
 	}
 
-	/* TODO: Binary search insert? */
+	/* rows go on the end, custom_list_resort() merges them into place */
 
 	pos = custom_list->num_rows;
 	custom_list->rows[pos] = newrecord;
@@ -716,24 +773,55 @@ custom_list_append (CustomList * custom_list, chanlistrow * newrecord)
 	gtk_tree_path_free (path);
 }
 
+void
+custom_list_append_rows (CustomList * custom_list, chanlistrow ** rows, guint n)
+{
+	guint i;
+
+	if (custom_list->num_rows + n > custom_list->num_alloc)
+	{
+		custom_list->num_alloc = MAX (custom_list->num_alloc * 2, custom_list->num_rows + n);
+		custom_list->rows = g_realloc (custom_list->rows,
+												 custom_list->num_alloc * sizeof (chanlistrow *));
+	}
+
+	for (i = 0; i < n; i++)
+		custom_list_append (custom_list, rows[i]);
+}
+
 void
 custom_list_resort (CustomList * custom_list)
 {
 	GtkTreePath *path;
 	gint *neworder, i;
+	guint start;
 
 	if (custom_list->num_rows < 2)
+	{
+		custom_list->num_sorted = custom_list->num_rows;
+		return;
+	}
+
+	/* only rows added since the last sort need sorting, then merging in */
+	start = custom_list->num_sorted;
+	if (start >= custom_list->num_rows)
 		return;
 
-	/* resort */
+	if (custom_list->sort_id == SORT_ID_CHANNEL)
+		custom_list_make_keys (custom_list, start);
+
 	G_GNUC_BEGIN_IGNORE_DEPRECATIONS
-	g_qsort_with_data (custom_list->rows,
-							 custom_list->num_rows,
+	g_qsort_with_data (custom_list->rows + start,
+							 custom_list->num_rows - start,
 							 sizeof (chanlistrow *),
 							 (GCompareDataFunc) custom_list_qsort_compare_func,
 							 custom_list);
 	G_GNUC_END_IGNORE_DEPRECATIONS
 
+	if (start > 0)
+		custom_list_merge_tail (custom_list);
+	custom_list->num_sorted = custom_list->num_rows;
+
 	/* let other objects know about the new order */
 	neworder = malloc (sizeof (gint) * custom_list->num_rows);
 
@@ -771,6 +859,7 @@ custom_list_clear (CustomList * custom_list)
 
 	custom_list->num_rows = 0;
 	custom_list->num_alloc = 0;
+	custom_list->num_sorted = 0;
 
 	g_free (custom_list->rows);
 	custom_list->rows = NULL;
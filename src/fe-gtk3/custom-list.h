@@ -57,10 +57,10 @@ enum
 typedef struct
 {
 	char *topic;
-	char *collation_key;
+	char *collation_key;			  /* made by custom_list_resort when needed */
 	guint32 pos;						  /* pos within the array */
 	guint32 users;
-	/* channel string lives beyond "users" */
+	/* channel string lives beyond "users", topic follows it */
 #define GET_CHAN(row) (((char *)row)+sizeof(chanlistrow))
 }
 chanlistrow;
@@ -84,6 +84,7 @@ struct _CustomList
 	guint num_alloc;					/* number of rows allocated */
 	chanlistrow **rows;			  /* a dynamically allocated array of pointers to the
 										   *  CustomRecord structure for each row */
+	guint num_sorted;				  /* rows[0..num_sorted) are in sort order */
 
 	gint n_columns;
 	GType column_types[CUSTOM_LIST_N_COLUMNS];
@@ -103,6 +104,7 @@ struct _CustomListClass
 
 CustomList *custom_list_new (void);
 void custom_list_append (CustomList *, chanlistrow *);
+void custom_list_append_rows (CustomList *, chanlistrow **, guint);
 void custom_list_resort (CustomList *);
 void custom_list_clear (CustomList *);
 
@@ -85,6 +85,20 @@ struct dccwindow
 
 	GtkWidget *file_label;
 	GtkWidget *address_label;
+
+	GHashTable *rows;	/* struct DCC * -> struct dcc_row */
+};
+
+/* A transfer's row and what was last written to it. GtkListStore iters
+ * stay valid until their row is removed, so the iter is kept as is. */
+struct dcc_row
+{
+	GtkTreeIter iter;
+	int dccstat;
+	char pos[16];
+	char perc[14];
+	char speed[16];
+	char eta[16];
 };
 
 struct my_dcc_send
@@ -156,6 +170,99 @@ fe_dcc_send_filereq (struct session *sess, char *nick, int maxcps, int passive)
 	gtkutil_file_req (tbuf, dcc_send_filereq_file, mdc, prefs.pchat_dcc_dir, NULL, FRF_MULTIPLE|FRF_FILTERISINITIAL);
 }
 
+static struct dcc_row *
+dcc_add_row (struct dccwindow *win, struct DCC *dcc, GtkTreeIter *iter)
+{
+	struct dcc_row *row;
+
+	if (!win->rows)
+		win->rows = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+	row = g_new0 (struct dcc_row, 1);
+	row->iter = *iter;
+	row->dccstat = -1;
+	g_hash_table_replace (win->rows, dcc, row);
+
+	return row;
+}
+
+static struct dcc_row *
+dcc_find_row (struct dccwindow *win, struct DCC *dcc)
+{
+	return win->rows ? g_hash_table_lookup (win->rows, dcc) : NULL;
+}
+
+static void
+dcc_clear_rows (struct dccwindow *win)
+{
+	if (win->rows)
+		g_hash_table_remove_all (win->rows);
+}
+
+static void
+dcc_row_value (GValue *value, GType type, gconstpointer data)
+{
+	g_value_init (value, type);
+	if (type == G_TYPE_STRING)
+		g_value_set_string (value, data);
+	else
+		g_value_set_boxed (value, data);
+}
+
+/* rewrite only the progress cells that changed since the last update;
+   returns TRUE if the status did */
+static gboolean
+dcc_update_row (GtkListStore *store, struct dcc_row *row, struct DCC *dcc,
+					 char *pos, char *perc, char *speed, char *eta)
+{
+	GValue values[6] = { G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT,
+								G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT };
+	int columns[6];
+	int i, n = 0;
+	gboolean status_changed = FALSE;
+
+	if (row->dccstat != dcc->dccstat)
+	{
+		row->dccstat = dcc->dccstat;
+		status_changed = TRUE;
+		columns[n] = COL_STATUS;
+		dcc_row_value (&values[n++], G_TYPE_STRING, _(dccstat[dcc->dccstat].name));
+		columns[n] = COL_COLOR;
+		dcc_row_value (&values[n++], GDK_TYPE_RGBA, dccstat[dcc->dccstat].color == 1 ?
+							NULL : colors + dccstat[dcc->dccstat].color);
+	}
+#define DCC_CELL(col, field, text) \
+	if (strcmp (row->field, text) != 0) \
+	{ \
+		g_strlcpy (row->field, text, sizeof (row->field)); \
+		columns[n] = col; \
+		dcc_row_value (&values[n++], G_TYPE_STRING, text); \
+	}
+	DCC_CELL (COL_POS, pos, pos)
+	DCC_CELL (COL_PERC, perc, perc)
+	DCC_CELL (COL_SPEED, speed, speed)
+	DCC_CELL (COL_ETA, eta, eta)
+#undef DCC_CELL
+
+	if (n)
+		gtk_list_store_set_valuesv (store, &row->iter, columns, values, n);
+	for (i = 0; i < n; i++)
+		g_value_unset (&values[i]);
+
+	return status_changed;
+}
+
+static void
+dcc_remember_row (struct dcc_row *row, struct DCC *dcc,
+						char *pos, char *perc, char *speed, char *eta)
+{
+	row->dccstat = dcc->dccstat;
+	g_strlcpy (row->pos, pos, sizeof (row->pos));
+	g_strlcpy (row->perc, perc, sizeof (row->perc));
+	g_strlcpy (row->speed, speed, sizeof (row->speed));
+	g_strlcpy (row->eta, eta, sizeof (row->eta));
+}
+
 static void
 dcc_prepare_row_chat (struct DCC *dcc, GtkListStore *store, GtkTreeIter *iter,
 							 gboolean update_only)
@@ -183,8 +290,8 @@ dcc_prepare_row_chat (struct DCC *dcc, GtkListStore *store, GtkTreeIter *iter,
 							  -1);
 }
 
-static void
-dcc_prepare_row_send (struct DCC *dcc, GtkListStore *store, GtkTreeIter *iter,
+static gboolean
+dcc_prepare_row_send (struct DCC *dcc, GtkListStore *store, struct dcc_row *row,
 							 gboolean update_only)
 {
 	static char pos[16], size[16], kbs[14], perc[14], eta[14];
@@ -220,38 +327,30 @@ dcc_prepare_row_send (struct DCC *dcc, GtkListStore *store, GtkTreeIter *iter,
 		strcpy (eta, "--:--:--");
 
 	if (update_only)
-		gtk_list_store_set (store, iter,
-								  COL_STATUS, _(dccstat[dcc->dccstat].name),
-								  COL_POS, pos,
-								  COL_PERC, perc,
-								  COL_SPEED, kbs,
-								  COL_ETA, eta,
-								  COL_COLOR,
-								  dccstat[dcc->dccstat].color == 1 ?
-									NULL :
-									colors + dccstat[dcc->dccstat].color,
-									-1);
-	else
-		gtk_list_store_set (store, iter,
-								  COL_TYPE, pix_up,
-								  COL_STATUS, _(dccstat[dcc->dccstat].name),
-								  COL_FILE, file_part (dcc->file),
-								  COL_SIZE, size,
-								  COL_POS, pos,
-								  COL_PERC, perc,
-								  COL_SPEED, kbs,
-								  COL_ETA, eta,
-								  COL_NICK, dcc->nick,
-								  COL_DCC, dcc,
-								  COL_COLOR,
-								  dccstat[dcc->dccstat].color == 1 ?
-									NULL :
-									colors + dccstat[dcc->dccstat].color,
-									-1);
+		return dcc_update_row (store, row, dcc, pos, perc, kbs, eta);
+
+	gtk_list_store_set (store, &row->iter,
+							  COL_TYPE, pix_up,
+							  COL_STATUS, _(dccstat[dcc->dccstat].name),
+							  COL_FILE, file_part (dcc->file),
+							  COL_SIZE, size,
+							  COL_POS, pos,
+							  COL_PERC, perc,
+							  COL_SPEED, kbs,
+							  COL_ETA, eta,
+							  COL_NICK, dcc->nick,
+							  COL_DCC, dcc,
+							  COL_COLOR,
+							  dccstat[dcc->dccstat].color == 1 ?
+								NULL :
+								colors + dccstat[dcc->dccstat].color,
+								-1);
+	dcc_remember_row (row, dcc, pos, perc, kbs, eta);
+	return FALSE;
 }
 
-static void
-dcc_prepare_row_recv (struct DCC *dcc, GtkListStore *store, GtkTreeIter *iter,
+static gboolean
+dcc_prepare_row_recv (struct DCC *dcc, GtkListStore *store, struct dcc_row *row,
 							 gboolean update_only)
 {
 	static char size[16], pos[16], kbs[16], perc[14], eta[16];
@@ -289,117 +388,101 @@ dcc_prepare_row_recv (struct DCC *dcc, GtkListStore *store, GtkTreeIter *iter,
 		strcpy (eta, "--:--:--");
 
 	if (update_only)
-		gtk_list_store_set (store, iter,
-								  COL_STATUS, _(dccstat[dcc->dccstat].name),
-								  COL_POS, pos,
-								  COL_PERC, perc,
-								  COL_SPEED, kbs,
-								  COL_ETA, eta,
-								  COL_COLOR,
-								  dccstat[dcc->dccstat].color == 1 ?
-									NULL :
-									colors + dccstat[dcc->dccstat].color,
-									-1);
-	else
-		gtk_list_store_set (store, iter,
-								  COL_TYPE, pix_dn,
-								  COL_STATUS, _(dccstat[dcc->dccstat].name),
-								  COL_FILE, file_part (dcc->file),
-								  COL_SIZE, size,
-								  COL_POS, pos,
-								  COL_PERC, perc,
-								  COL_SPEED, kbs,
-								  COL_ETA, eta,
-								  COL_NICK, dcc->nick,
-								  COL_DCC, dcc,
-								  COL_COLOR,
-								  dccstat[dcc->dccstat].color == 1 ?
-									NULL :
-									colors + dccstat[dcc->dccstat].color,
-									-1);
+		return dcc_update_row (store, row, dcc, pos, perc, kbs, eta);
+
+	gtk_list_store_set (store, &row->iter,
+							  COL_TYPE, pix_dn,
+							  COL_STATUS, _(dccstat[dcc->dccstat].name),
+							  COL_FILE, file_part (dcc->file),
+							  COL_SIZE, size,
+							  COL_POS, pos,
+							  COL_PERC, perc,
+							  COL_SPEED, kbs,
+							  COL_ETA, eta,
+							  COL_NICK, dcc->nick,
+							  COL_DCC, dcc,
+							  COL_COLOR,
+							  dccstat[dcc->dccstat].color == 1 ?
+								NULL :
+								colors + dccstat[dcc->dccstat].color,
+								-1);
+	dcc_remember_row (row, dcc, pos, perc, kbs, eta);
+	return FALSE;
 }
 
+/* nothing is written to the transfer list while it can't be seen, be it
+   a hidden tab or a minimized window; dcc_file_win_map () catches up */
 static gboolean
-dcc_find_row (struct DCC *find_dcc, GtkTreeModel *model, GtkTreeIter *iter, int col)
+dcc_file_win_visible (void)
 {
-	struct DCC *dcc;
-
-	if (gtk_tree_model_get_iter_first (model, iter))
-	{
-		do
-		{
-			gtk_tree_model_get (model, iter, col, &dcc, -1);
-			if (dcc == find_dcc)
-				return TRUE;
-		}
-		while (gtk_tree_model_iter_next (model, iter));
-	}
-
-	return FALSE;
+	return dccfwin.window && gtk_widget_get_mapped (dccfwin.window);
 }
 
-static void
+static gboolean
 dcc_update_recv (struct DCC *dcc)
 {
-	GtkTreeIter iter;
+	struct dcc_row *row;
 
-	if (!dccfwin.window)
-		return;
+	if (!dcc_file_win_visible ())
+		return FALSE;
 
-	if (!dcc_find_row (dcc, GTK_TREE_MODEL (dccfwin.store), &iter, COL_DCC))
-		return;
+	if (!(row = dcc_find_row (&dccfwin, dcc)))
+		return FALSE;
 
-	dcc_prepare_row_recv (dcc, dccfwin.store, &iter, TRUE);
+	return dcc_prepare_row_recv (dcc, dccfwin.store, row, TRUE);
 }
 
 static void
 dcc_update_chat (struct DCC *dcc)
 {
-	GtkTreeIter iter;
+	struct dcc_row *row;
 
 	if (!dcccwin.window)
 		return;
 
-	if (!dcc_find_row (dcc, GTK_TREE_MODEL (dcccwin.store), &iter, CCOL_DCC))
+	if (!(row = dcc_find_row (&dcccwin, dcc)))
 		return;
 
-	dcc_prepare_row_chat (dcc, dcccwin.store, &iter, TRUE);
+	dcc_prepare_row_chat (dcc, dcccwin.store, &row->iter, TRUE);
 }
 
-static void
+static gboolean
 dcc_update_send (struct DCC *dcc)
 {
-	GtkTreeIter iter;
+	struct dcc_row *row;
 
-	if (!dccfwin.window)
-		return;
+	if (!dcc_file_win_visible ())
+		return FALSE;
 
-	if (!dcc_find_row (dcc, GTK_TREE_MODEL (dccfwin.store), &iter, COL_DCC))
-		return;
+	if (!(row = dcc_find_row (&dccfwin, dcc)))
+		return FALSE;
 
-	dcc_prepare_row_send (dcc, dccfwin.store, &iter, TRUE);
+	return dcc_prepare_row_send (dcc, dccfwin.store, row, TRUE);
 }
 
 static void
 close_dcc_file_window (GtkWindow *win, gpointer data)
 {
 	dccfwin.window = NULL;
+	g_clear_pointer (&dccfwin.rows, g_hash_table_destroy);
 }
 
 static void
 dcc_append (struct DCC *dcc, GtkListStore *store, gboolean prepend)
 {
 	GtkTreeIter iter;
+	struct dcc_row *row;
 
 	if (prepend)
 		gtk_list_store_prepend (store, &iter);
 	else
 		gtk_list_store_append (store, &iter);
 
+	row = dcc_add_row (&dccfwin, dcc, &iter);
 	if (dcc->type == TYPE_RECV)
-		dcc_prepare_row_recv (dcc, store, &iter, FALSE);
+		dcc_prepare_row_recv (dcc, store, row, FALSE);
 	else
-		dcc_prepare_row_send (dcc, store, &iter, FALSE);
+		dcc_prepare_row_send (dcc, store, row, FALSE);
 }
 
 /* Returns aborted and completed transfers. */
@@ -446,6 +529,28 @@ update_clear_button_sensitivity (void)
 	gtk_widget_set_sensitive (dccfwin.clear_button, sensitive);
 }
 
+/* bring every row up to date when the list is shown again */
+static void
+dcc_file_win_map (GtkWidget *wid, gpointer data)
+{
+	GHashTableIter iter;
+	gpointer dcc, row;
+
+	if (!dccfwin.rows)
+		return;
+
+	g_hash_table_iter_init (&iter, dccfwin.rows);
+	while (g_hash_table_iter_next (&iter, &dcc, &row))
+	{
+		if (((struct DCC *) dcc)->type == TYPE_RECV)
+			dcc_prepare_row_recv (dcc, dccfwin.store, row, TRUE);
+		else
+			dcc_prepare_row_send (dcc, dccfwin.store, row, TRUE);
+	}
+
+	update_clear_button_sensitivity ();
+}
+
 static void
 dcc_fill_window (int flags)
 {
@@ -454,6 +559,7 @@ dcc_fill_window (int flags)
 	GtkTreeIter iter;
 	int i = 0;
 
+	dcc_clear_rows (&dccfwin);
 	gtk_list_store_clear (GTK_LIST_STORE (dccfwin.store));
 
 	if (flags & VIEW_UPLOAD)
@@ -861,6 +967,8 @@ fe_dcc_open_recv_win (int passive)
 								G_CALLBACK (dcc_configure_cb), 0);
 	g_signal_connect (G_OBJECT (dccfwin.sel), "changed",
 							G_CALLBACK (dcc_row_cb), NULL);
+	g_signal_connect (G_OBJECT (dccfwin.window), "map",
+							G_CALLBACK (dcc_file_win_map), NULL);
 	/* double click */
 	g_signal_connect (G_OBJECT (view), "row-activated",
 							G_CALLBACK (dcc_dclick_cb), NULL);
@@ -973,6 +1081,7 @@ static void
 dcc_chat_close_cb (void)
 {
 	dcccwin.window = NULL;
+	g_clear_pointer (&dcccwin.rows, g_hash_table_destroy);
 }
 
 static void
@@ -985,6 +1094,7 @@ dcc_chat_append (struct DCC *dcc, GtkListStore *store, gboolean prepend)
 	else
 		gtk_list_store_append (store, &iter);
 
+	dcc_add_row (&dcccwin, dcc, &iter);
 	dcc_prepare_row_chat (dcc, store, &iter, FALSE);
 }
 
@@ -996,6 +1106,7 @@ dcc_chat_fill_win (void)
 	GtkTreeIter iter;
 	int i = 0;
 
+	dcc_clear_rows (&dcccwin);
 	gtk_list_store_clear (GTK_LIST_STORE (dcccwin.store));
 
 	list = dcc_list;
@@ -1140,45 +1251,48 @@ fe_dcc_add (struct DCC *dcc)
 void
 fe_dcc_update (struct DCC *dcc)
 {
+	gboolean status_changed = FALSE;
+
 	switch (dcc->type)
 	{
 	case TYPE_SEND:
-		dcc_update_send (dcc);
+		status_changed = dcc_update_send (dcc);
 		break;
 
 	case TYPE_RECV:
-		dcc_update_recv (dcc);
+		status_changed = dcc_update_recv (dcc);
 		break;
 
 	default:
 		dcc_update_chat (dcc);
 	}
 
-	if (dccfwin.window)
+	/* only a change of status can complete or abort a transfer */
+	if (status_changed)
 		update_clear_button_sensitivity();
 }
 
 void
 fe_dcc_remove (struct DCC *dcc)
 {
-	GtkTreeIter iter;
+	struct dcc_row *row;
 
 	switch (dcc->type)
 	{
 	case TYPE_SEND:
 	case TYPE_RECV:
-		if (dccfwin.window)
+		if (dccfwin.window && (row = dcc_find_row (&dccfwin, dcc)))
 		{
-			if (dcc_find_row (dcc, GTK_TREE_MODEL (dccfwin.store), &iter, COL_DCC))
-				gtk_list_store_remove (dccfwin.store, &iter);
+			gtk_list_store_remove (dccfwin.store, &row->iter);
+			g_hash_table_remove (dccfwin.rows, dcc);
 		}
 		break;
 
 	default:	/* chat */
-		if (dcccwin.window)
+		if (dcccwin.window && (row = dcc_find_row (&dcccwin, dcc)))
 		{
-			if (dcc_find_row (dcc, GTK_TREE_MODEL (dcccwin.store), &iter, CCOL_DCC))
-				gtk_list_store_remove (dcccwin.store, &iter);
+			gtk_list_store_remove (dcccwin.store, &row->iter);
+			g_hash_table_remove (dcccwin.rows, dcc);
 		}
 		break;
 	}
@@ -758,6 +758,12 @@ fe_print_text (struct session *sess, char *text, time_t stamp,
 	}
 }
 
+void
+fe_prepend_text (struct session *sess, char *text, time_t stamp)
+{
+	PrintTextPrepend (sess->res->buffer, (unsigned char *)text, prefs.pchat_text_indent, stamp);
+}
+
 void
 fe_beep (session *sess)
 {
@@ -78,8 +78,12 @@ struct server_gui
 	GtkWidget *chanlist_savelist;
 	GtkWidget *chanlist_search;
 
-	GSList *chanlist_data_stored_rows;	/* stored list so it can be resorted  */
-	GSList *chanlist_pending_rows;
+	GPtrArray *chanlist_rows;	/* every row received, so it can be refiltered */
+	GPtrArray *chanlist_pending_rows;
+	GSList *chanlist_blocks;	/* memory the rows live in, newest first */
+	gsize chanlist_block_used;
+	gsize chanlist_block_size;
+	char *chanlist_filter;		/* text of chanlist_wild */
 	gint chanlist_tag;
 	gint chanlist_flash_tag;
 
@@ -1339,14 +1339,6 @@ cmdlist_double_list (GSList *inlist)
 	return list;
 }
 
-static char *
-gcomp_nick_func (char *data)
-{
-	if (data)
-		return ((struct User *)data)->nick;
-	return "";
-}
-
 void
 key_action_tab_clean(void)
 {
@@ -1385,16 +1377,80 @@ talked_recent_cmp (struct User *a, struct User *b)
 	return 0;
 }
 
+/* Nicks starting with prefix, taken from the session's completion index
+ * and put in userlist order, or most recent talker first. */
+static GList *
+tab_comp_nicks (session *sess, char *prefix)
+{
+	GList *list, *users;
+
+	users = userlist_complete (sess, prefix);
+	users = g_list_sort_with_data (users, (GCompareDataFunc)nick_cmp, sess->server);
+	if (prefs.pchat_completion_sort == 1)	/* sort in last-talk order? */
+	{
+		users = g_list_reverse (users);
+		users = g_list_sort (users, (GCompareFunc)talked_recent_cmp);
+		users = g_list_reverse (users);
+	}
+
+	for (list = users; list; list = list->next)
+		list->data = ((struct User *)list->data)->nick;
+
+	return users;
+}
+
+/* drop the items that don't start with prefix */
+static GList *
+tab_comp_filter (GList *items, char *prefix)
+{
+	GList *list, *next;
+	int len = strlen (prefix);
+
+	for (list = items; list; list = next)
+	{
+		next = list->next;
+		if (rfc_ncasecmp (prefix, list->data, len) != 0)
+			items = g_list_delete_link (items, list);
+	}
+
+	return items;
+}
+
+/* longest prefix shared by all matches, cut back to a whole utf8 char */
+static char *
+tab_comp_prefix (GList *matches)
+{
+	GList *list;
+	const char *first, *s;
+	const gchar *end;
+	int len, i;
+
+	if (!matches)
+		return NULL;
+
+	first = matches->data;
+	len = strlen (first);
+	for (list = matches->next; list; list = list->next)
+	{
+		s = list->data;
+		for (i = 0; i < len && s[i] && rfc_tolower (first[i]) == rfc_tolower (s[i]); i++)
+			;
+		len = i;
+	}
+
+	g_utf8_validate (first, len, &end);
+	return g_strndup (first, end - first);
+}
+
 static int
 key_action_tab_comp (GtkWidget *t, GdkEventKey *entry, char *d1, char *d2,
 							struct session *sess)
 {
 	int len = 0, elen = 0, i = 0, cursor_pos, ent_start = 0, comp = 0, found = 0,
 	    prefix_len, skip_len = 0, is_nick, is_cmd = 0;
-	char buf[COMP_BUF], ent[CHANLEN], *postfix = NULL, *result, *ch;
-	GList *list = NULL, *tmp_list = NULL;
+	char buf[COMP_BUF], ent[CHANLEN], *postfix = NULL, *result, *ch, *match;
+	GList *list = NULL, *tmp_list = NULL, *matches = NULL;
 	const char *text;
-	GCompletion *gcomp = NULL;
 
 	/* force the IM Context to reset */
 	SPELL_ENTRY_SET_EDITABLE (t, FALSE);
@@ -1471,16 +1527,20 @@ key_action_tab_comp (GtkWidget *t, GdkEventKey *entry, char *d1, char *d2,
 	}
 	else
 	{
-		if (is_nick)
+		if (comp && !(rfc_ncasecmp(old_gcomp.data, ent, old_gcomp.elen) == 0))
 		{
-			gcomp = g_completion_new((GCompletionFunc)gcomp_nick_func);
-			tmp_list = userlist_double_list(sess); /* create a temp list so we can free the memory */
-			if (prefs.pchat_completion_sort == 1)	/* sort in last-talk order? */
-				tmp_list = g_list_sort (tmp_list, (void *)talked_recent_cmp);
+			key_action_tab_clean ();
+			comp = 0;
 		}
+
+		match = comp ? old_gcomp.data : ent;
+		if (match[0] == 0)
+			return 2;
+
+		if (is_nick)
+			matches = tab_comp_nicks (sess, match);
 		else
 		{
-			gcomp = g_completion_new (NULL);
 			if (is_cmd)
 			{
 				tmp_list = cmdlist_double_list (command_list);
@@ -1492,28 +1552,15 @@ key_action_tab_comp (GtkWidget *t, GdkEventKey *entry, char *d1, char *d2,
 			}
 			else
 				tmp_list = chanlist_double_list (sess_list);
-		}
-		tmp_list = g_list_reverse(tmp_list); /* make the comp entries turn up in the right order */
-		g_completion_set_compare (gcomp, (GCompletionStrncmpFunc)rfc_ncasecmp);
-		if (tmp_list)
-		{
-			g_completion_add_items (gcomp, tmp_list);
-			g_list_free (tmp_list);
-		}
-
-		if (comp && !(rfc_ncasecmp(old_gcomp.data, ent, old_gcomp.elen) == 0))
-		{
-			key_action_tab_clean ();
-			comp = 0;
+			tmp_list = g_list_reverse(tmp_list); /* make the comp entries turn up in the right order */
+			matches = tab_comp_filter (tmp_list, match);
 		}
 
-		list = g_completion_complete_utf8 (gcomp, comp ? old_gcomp.data : ent, &result);
+		list = matches;
+		result = tab_comp_prefix (matches);
 
 		if (result == NULL) /* No matches found */
-		{
-			g_completion_free(gcomp);
 			return 2;
-		}
 
 		if (comp) /* existing completion */
 		{
@@ -1549,7 +1596,7 @@ key_action_tab_comp (GtkWidget *t, GdkEventKey *entry, char *d1, char *d2,
 			else
 			{
 				g_free(result);
-				g_completion_free(gcomp);
+				g_list_free (matches);
 				return 2;
 			}
 		}
@@ -1602,7 +1649,7 @@ key_action_tab_comp (GtkWidget *t, GdkEventKey *entry, char *d1, char *d2,
 						list = list->next;
 					}
 					PrintText (sess, buf);
-					g_completion_free(gcomp);
+					g_list_free (matches);
 					return 2;
 				}
 				/* Only one matching entry */
@@ -1626,8 +1673,7 @@ key_action_tab_comp (GtkWidget *t, GdkEventKey *entry, char *d1, char *d2,
 		SPELL_ENTRY_SET_TEXT (t, buf);
 		SPELL_ENTRY_SET_POS (t, g_utf8_pointer_to_offset(buf, buf + cursor_pos));
 	}
-	if (gcomp)
-		g_completion_free(gcomp);
+	g_list_free (matches);
 	return 2;
 }
 #undef COMP_BUF
@@ -1769,6 +1769,7 @@ mg_add_chan (session *sess)
 	if (sess->res->buffer == NULL)
 	{
 		sess->res->buffer = pchat_chat_buffer_new (PCHAT_TEXTVIEW_CHAT (sess->gui->textview));
+		sess->res->buffer->user_data = sess;
 		pchat_textview_chat_set_show_timestamps (PCHAT_TEXTVIEW_CHAT (sess->gui->textview), prefs.pchat_stamp_text);
 		sess->res->user_model = userlist_create_model ();
 	}
@@ -2300,6 +2301,17 @@ mg_word_check (GtkWidget * xtext, char *word)
 
 /* mouse click inside text area */
 
+/* scrolled to the top of the text, page in older scrollback */
+
+static void
+mg_top_reached (GtkWidget *xtext, gpointer userdata)
+{
+	PchatChatBuffer *buf = pchat_textview_chat_get_buffer (PCHAT_TEXTVIEW_CHAT (xtext));
+
+	if (buf && buf->user_data && is_session (buf->user_data))
+		scrollback_load_older (buf->user_data, 200);
+}
+
 static void
 mg_word_clicked (GtkWidget *xtext, char *word, GdkEventButton *even)
 {
@@ -2400,6 +2412,7 @@ mg_update_xtext (GtkWidget *wid)
 
 	pchat_textview_chat_set_palette (chat, colors, 37);
 	pchat_textview_chat_set_max_lines (chat, prefs.pchat_text_max_lines);
+	pchat_textview_chat_set_buffer_release (chat, prefs.pchat_text_buffer_release);
 	/* Background image not yet supported */
 	pchat_textview_chat_set_wordwrap (chat, prefs.pchat_text_wordwrap);
 	pchat_textview_chat_set_show_separator (chat, prefs.pchat_text_indent ? prefs.pchat_text_show_sep : 0);
@@ -2449,6 +2462,8 @@ mg_create_textarea (session *sess, GtkWidget *box)
 
 	g_signal_connect (G_OBJECT (gui->textview), "word-clicked",
 							G_CALLBACK (mg_word_clicked), NULL);
+	g_signal_connect (G_OBJECT (gui->textview), "top-reached",
+							G_CALLBACK (mg_top_reached), NULL);
 #ifndef _WIN32	/* needs more work */
 	gtk_drag_dest_set (gui->vscrollbar, 5, dnd_dest_targets, 2,
 							 GDK_ACTION_MOVE | GDK_ACTION_COPY | GDK_ACTION_LINK);
@@ -3394,6 +3409,7 @@ mg_create_topwindow (session *sess)
 	if (sess->res->buffer == NULL)
 	{
 		sess->res->buffer = pchat_chat_buffer_new (PCHAT_TEXTVIEW_CHAT (sess->gui->textview));
+		sess->res->buffer->user_data = sess;
 		pchat_chat_buffer_show (PCHAT_TEXTVIEW_CHAT (sess->gui->textview), sess->res->buffer);
 		pchat_textview_chat_set_show_timestamps (PCHAT_TEXTVIEW_CHAT (sess->gui->textview), prefs.pchat_stamp_text);
 		sess->res->user_model = userlist_create_model ();
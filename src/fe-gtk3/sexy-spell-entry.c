@@ -86,6 +86,17 @@ static void (*enchant_dict_store_replacement) (struct EnchantDict * dict, const
 static char ** (*enchant_dict_suggest) (struct EnchantDict * dict, const char *const word, ssize_t len, size_t * out_n_suggs);
 static gboolean have_enchant = FALSE;
 
+/* Number of dictionary results remembered per entry, and how many new
+ * words an idle pass may look up before yielding to the main loop. */
+#define SPELL_CACHE_SIZE 512
+#define SPELL_IDLE_CHECKS 32
+
+typedef struct
+{
+	gchar                *word;
+	gboolean              misspelled;
+} SpellCacheItem;
+
 struct _SexySpellEntryPriv
 {
 	struct EnchantBroker *broker;
@@ -98,6 +109,12 @@ struct _SexySpellEntryPriv
 	gint                 *word_ends;
 	gboolean              checked;
 	gboolean              parseattr;
+	GHashTable           *word_cache;	/* word -> link in word_lru */
+	GQueue                word_lru;		/* SpellCacheItem, most recent first */
+	gint                  check_budget;	/* lookups left, -1 for no limit */
+	gboolean              check_pending;
+	guint                 check_idle;
+	gint                  check_pos;	/* next word the idle check looks up */
 };
 
 static void sexy_spell_entry_class_init(SexySpellEntryClass *klass);
@@ -127,6 +144,8 @@ static gboolean   sexy_spell_entry_activate_language_internal (SexySpellEntry
                                                                GError              **error);
 static gchar     *get_lang_from_dict                          (struct EnchantDict   *dict);
 static void       sexy_spell_entry_recheck_all                (SexySpellEntry       *entry);
+static void       sexy_spell_entry_recheck_deferred           (SexySpellEntry       *entry);
+static void       spell_cache_clear                           (SexySpellEntry       *entry);
 static void       entry_strsplit_utf8                         (GtkEntry             *entry,
                                                                gchar              ***set,
                                                                gint                **starts,
@@ -452,6 +471,7 @@ add_to_dictionary(GtkWidget *menuitem, SexySpellEntry *entry)
 		enchant_dict_add_to_personal(dict, word, -1);
 
 	g_free(word);
+	spell_cache_clear (entry);
 
 	if (entry->priv->words) {
 		g_strfreev(entry->priv->words);
@@ -481,6 +501,7 @@ ignore_all(GtkWidget *menuitem, SexySpellEntry *entry)
 	}
 
 	g_free(word);
+	spell_cache_clear (entry);
 
 	if (entry->priv->words) {
 		g_strfreev(entry->priv->words);
@@ -728,6 +749,9 @@ sexy_spell_entry_init(SexySpellEntry *entry)
 	entry->priv = g_new0(SexySpellEntryPriv, 1);
 
 	entry->priv->dict_hash = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	entry->priv->word_cache = g_hash_table_new (g_str_hash, g_str_equal);
+	g_queue_init (&entry->priv->word_lru);
+	entry->priv->check_budget = -1;
 
 	if (have_enchant)
 	{
@@ -759,6 +783,10 @@ sexy_spell_entry_finalize(GObject *obj)
 
 	entry = SEXY_SPELL_ENTRY(obj);
 
+	if (entry->priv->check_idle)
+		g_source_remove (entry->priv->check_idle);
+	spell_cache_clear (entry);
+	g_hash_table_destroy (entry->priv->word_cache);
 	if (entry->priv->attr_list)
 		pango_attr_list_unref(entry->priv->attr_list);
 	if (entry->priv->dict_hash)
@@ -823,11 +851,45 @@ sexy_spell_error_quark(void)
 	return q;
 }
 
+static void
+spell_cache_clear (SexySpellEntry *entry)
+{
+	SpellCacheItem *item;
+
+	g_hash_table_remove_all (entry->priv->word_cache);
+	while ((item = g_queue_pop_head (&entry->priv->word_lru)))
+	{
+		g_free (item->word);
+		g_free (item);
+	}
+}
+
+static void
+spell_cache_store (SexySpellEntry *entry, const gchar *word, gboolean misspelled)
+{
+	SpellCacheItem *item;
+
+	if (g_queue_get_length (&entry->priv->word_lru) >= SPELL_CACHE_SIZE)
+	{
+		item = g_queue_pop_tail (&entry->priv->word_lru);
+		g_hash_table_remove (entry->priv->word_cache, item->word);
+		g_free (item->word);
+		g_free (item);
+	}
+
+	item = g_new (SpellCacheItem, 1);
+	item->word = g_strdup (word);
+	item->misspelled = misspelled;
+	g_queue_push_head (&entry->priv->word_lru, item);
+	g_hash_table_insert (entry->priv->word_cache, item->word, entry->priv->word_lru.head);
+}
+
 static gboolean
 default_word_check(SexySpellEntry *entry, const gchar *word)
 {
 	gboolean result = TRUE;
 	GSList *li;
+	GList *link;
 
 	if (!have_enchant)
 		return result;
@@ -836,6 +898,24 @@ default_word_check(SexySpellEntry *entry, const gchar *word)
 		/* We only want to check words */
 		return FALSE;
 	}
+
+	link = g_hash_table_lookup (entry->priv->word_cache, word);
+	if (link)
+	{
+		g_queue_unlink (&entry->priv->word_lru, link);
+		g_queue_push_head_link (&entry->priv->word_lru, link);
+		return ((SpellCacheItem *) link->data)->misspelled;
+	}
+
+	/* Out of lookups for this pass, leave it unmarked until the idle check */
+	if (entry->priv->check_budget == 0)
+	{
+		entry->priv->check_pending = TRUE;
+		return FALSE;
+	}
+	if (entry->priv->check_budget > 0)
+		entry->priv->check_budget--;
+
 	for (li = entry->priv->dict_list; li; li = g_slist_next (li)) {
 		struct EnchantDict *dict = (struct EnchantDict *) li->data;
 		if (enchant_dict_check(dict, word, strlen(word)) == 0) {
@@ -843,6 +923,8 @@ default_word_check(SexySpellEntry *entry, const gchar *word)
 			break;
 		}
 	}
+
+	spell_cache_store (entry, word, result);
 	return result;
 }
 
@@ -1074,6 +1156,65 @@ sexy_spell_entry_recheck_all(SexySpellEntry *entry)
 	}
 }
 
+/* Recheck with at most budget dictionary lookups, returns TRUE if some
+ * words were left unchecked */
+static gboolean
+sexy_spell_entry_recheck_budget (SexySpellEntry *entry, gint budget)
+{
+	entry->priv->check_budget = budget;
+	entry->priv->check_pending = FALSE;
+	sexy_spell_entry_recheck_all (entry);
+	entry->priv->check_budget = -1;
+
+	return entry->priv->check_pending;
+}
+
+/* Looks up the next few words from where the last pass stopped, a full
+ * recheck from the start could evict what earlier passes cached and never
+ * finish on text with more words than the cache holds */
+static gboolean
+sexy_spell_entry_check_idle (gpointer data)
+{
+	SexySpellEntry *entry = SEXY_SPELL_ENTRY (data);
+	gchar **words = entry->priv->words;
+	gint i;
+
+	if (words && have_enchant && entry->priv->checked
+		&& g_slist_length (entry->priv->dict_list) != 0)
+	{
+		/* The text may have been split again since the last pass */
+		for (i = 0; words[i] && i < entry->priv->check_pos; i++)
+			;
+
+		entry->priv->check_budget = SPELL_IDLE_CHECKS;
+		for (; words[i] && entry->priv->check_budget > 0; i++)
+		{
+			if (words[i][0] != 0)
+				word_misspelled (entry, entry->priv->word_starts[i], entry->priv->word_ends[i]);
+		}
+		entry->priv->check_budget = -1;
+		entry->priv->check_pos = i;
+
+		sexy_spell_entry_recheck_budget (entry, 0);
+		if (words[i])
+			return G_SOURCE_CONTINUE;
+	}
+
+	entry->priv->check_pos = 0;
+	entry->priv->check_idle = 0;
+	return G_SOURCE_REMOVE;
+}
+
+/* Words already in the cache are marked right away, new ones are looked
+ * up from an idle handler so typing never waits on the dictionaries */
+static void
+sexy_spell_entry_recheck_deferred (SexySpellEntry *entry)
+{
+	entry->priv->check_pos = 0;
+	if (sexy_spell_entry_recheck_budget (entry, 0) && !entry->priv->check_idle)
+		entry->priv->check_idle = g_idle_add (sexy_spell_entry_check_idle, entry);
+}
+
 #if 0 /* FIXME: move to draw signal */
 static gint
 sexy_spell_entry_expose(GtkWidget *widget, GdkEventExpose *event)
@@ -1172,7 +1313,7 @@ sexy_spell_entry_changed(GtkEditable *editable, gpointer data)
 		g_free(entry->priv->word_ends);
 	}
 	entry_strsplit_utf8(GTK_ENTRY(entry), &entry->priv->words, &entry->priv->word_starts, &entry->priv->word_ends);
-	sexy_spell_entry_recheck_all(entry);
+	sexy_spell_entry_recheck_deferred (entry);
 }
 
 static gboolean
@@ -1279,6 +1420,7 @@ sexy_spell_entry_activate_language_internal(SexySpellEntry *entry, const gchar *
 
 	enchant_dict_add_to_session (dict, "PChat", strlen("PChat"));
 	entry->priv->dict_list = g_slist_append(entry->priv->dict_list, (gpointer) dict);
+	spell_cache_clear (entry);
 	g_hash_table_insert(entry->priv->dict_hash, get_lang_from_dict(dict), (gpointer) dict);
 
 	return TRUE;
@@ -1460,6 +1602,7 @@ sexy_spell_entry_deactivate_language(SexySpellEntry *entry, const gchar *lang)
 		entry->priv->dict_hash = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 		entry->priv->dict_list = NULL;
 	}
+	spell_cache_clear (entry);
 
 	if (entry->priv->words) {
 		g_strfreev(entry->priv->words);
@@ -150,6 +150,37 @@ PrintTextRaw (void *buf_ptr, unsigned char *text, int indent, time_t stamp)
 	}
 }
 
+/* prepend a single line, splitting it like PrintTextLine does */
+void
+PrintTextPrepend (void *buf_ptr, unsigned char *text, int indent, time_t stamp)
+{
+	PchatChatBuffer *buf = (PchatChatBuffer *)buf_ptr;
+	unsigned char *tab;
+	int len;
+
+	if (!(current_sess && current_sess->gui && current_sess->gui->textview))
+		return;
+
+	len = strcspn (text, "\n");
+	if (len == 0)
+		len = 1;
+
+	tab = indent ? memchr (text, '\t', len) : NULL;
+	if (tab)
+	{
+		pchat_chat_buffer_prepend_indent (buf, PCHAT_TEXTVIEW_CHAT (current_sess->gui->textview),
+		                                  (const gchar *)text, tab - text,
+		                                  (const gchar *)(tab + 1), len - (tab - text + 1),
+		                                  stamp);
+	} else
+	{
+		pchat_chat_buffer_prepend_indent (buf, PCHAT_TEXTVIEW_CHAT (current_sess->gui->textview),
+		                                  NULL, 0,
+		                                  (const gchar *)text, len,
+		                                  stamp);
+	}
+}
+
 static void
 pevent_dialog_close (GtkWidget *wid, gpointer arg)
 {
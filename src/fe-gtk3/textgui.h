@@ -24,6 +24,7 @@
 #define PCHAT_TEXTGUI_H
 
 void PrintTextRaw (void *xtbuf, unsigned char *text, int indent, time_t stamp);
+void PrintTextPrepend (void *xtbuf, unsigned char *text, int indent, time_t stamp);
 void pevent_dialog_show (void);
 
 #endif
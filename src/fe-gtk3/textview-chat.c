@@ -66,17 +66,32 @@ struct _PchatTextViewChatPrivate
 	
 	/* Line counter */
 	gint line_count;
+	
+	/* Seconds a hidden buffer keeps its GtkTextBuffer, 0 = forever */
+	gint buffer_release;
+	
+	/* "top-reached" emission */
+	GtkAdjustment *top_vadj;          /* Adjustment being watched */
+	guint top_timeout;                /* Pending recheck, 0 if none */
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (PchatTextViewChat, pchat_textview_chat, GTK_TYPE_TEXT_VIEW)
 
 enum {
 	WORD_CLICKED,
+	TOP_REACHED,
 	LAST_SIGNAL
 };
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
+/* One line kept in PchatChatBuffer->lines, the text as it was appended
+ * (IRC formatting codes included, timestamp already prefixed) */
+typedef struct {
+	gsize len;
+	gchar text[1];
+} PchatRawLine;
+
 /* Idle callback data for deferred scrolling */
 typedef struct {
 	PchatTextViewChat *chat;
@@ -353,6 +368,80 @@ pchat_textview_chat_leave_notify (GtkWidget *widget, GdkEventCrossing *event, gp
 	return FALSE;
 }
 
+/* "top-reached" is only emitted if the view is still at the top a moment
+ * later, so the transient top position while switching buffers (before
+ * scroll_to_mark_idle runs) doesn't trigger it */
+#define TOP_REACHED_DELAY 150
+
+static gboolean
+is_scrolled_to_top (PchatTextViewChat *chat)
+{
+	GtkAdjustment *vadj;
+	
+	vadj = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (chat));
+	if (!vadj)
+		return FALSE;
+	
+	return gtk_adjustment_get_value (vadj) <= gtk_adjustment_get_lower (vadj);
+}
+
+static gboolean
+top_reached_timeout (gpointer user_data)
+{
+	PchatTextViewChat *chat = user_data;
+	
+	chat->priv->top_timeout = 0;
+	
+	if (chat->priv->current_buffer && is_scrolled_to_top (chat))
+		g_signal_emit (chat, signals[TOP_REACHED], 0);
+	
+	return G_SOURCE_REMOVE;
+}
+
+static void
+queue_top_reached (PchatTextViewChat *chat)
+{
+	if (chat->priv->top_timeout == 0)
+		chat->priv->top_timeout = g_timeout_add (TOP_REACHED_DELAY, top_reached_timeout, chat);
+}
+
+static void
+pchat_textview_chat_vadj_changed (GtkAdjustment *vadj, PchatTextViewChat *chat)
+{
+	/* Only scrollable content can be scrolled to the top */
+	if (gtk_adjustment_get_upper (vadj) > gtk_adjustment_get_page_size (vadj) &&
+	    gtk_adjustment_get_value (vadj) <= gtk_adjustment_get_lower (vadj))
+		queue_top_reached (chat);
+}
+
+static gboolean
+pchat_textview_chat_scroll_event (GtkWidget *widget, GdkEventScroll *event, gpointer user_data)
+{
+	PchatTextViewChat *chat = PCHAT_TEXTVIEW_CHAT (widget);
+	
+	/* Scrolling up when already at the top (or with too little text to scroll) */
+	if ((event->direction == GDK_SCROLL_UP ||
+	     (event->direction == GDK_SCROLL_SMOOTH && event->delta_y < 0)) &&
+	    is_scrolled_to_top (chat))
+		queue_top_reached (chat);
+	
+	return FALSE;
+}
+
+static void
+pchat_textview_chat_watch_top (PchatTextViewChat *chat)
+{
+	GtkAdjustment *vadj;
+	
+	vadj = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (chat));
+	if (!vadj || vadj == chat->priv->top_vadj)
+		return;
+	
+	chat->priv->top_vadj = vadj;
+	g_signal_connect_object (vadj, "value-changed",
+	                         G_CALLBACK (pchat_textview_chat_vadj_changed), chat, 0);
+}
+
 static void
 pchat_textview_chat_realize (GtkWidget *widget, gpointer user_data)
 {
@@ -367,6 +456,8 @@ pchat_textview_chat_realize (GtkWidget *widget, gpointer user_data)
 		pchat_textview_chat_set_font (chat, font_name_copy);
 		g_free (font_name_copy);
 	}
+	
+	pchat_textview_chat_watch_top (chat);
 }
 
 static void
@@ -393,6 +484,9 @@ pchat_textview_chat_finalize (GObject *object)
 	
 	g_free (priv->font_name);
 	
+	if (priv->top_timeout)
+		g_source_remove (priv->top_timeout);
+	
 	G_OBJECT_CLASS (pchat_textview_chat_parent_class)->finalize (object);
 }
 
@@ -412,6 +506,14 @@ pchat_textview_chat_class_init (PchatTextViewChatClass *klass)
 	                                       G_TYPE_NONE, 2,
 	                                       G_TYPE_STRING,
 	                                       GDK_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+	
+	signals[TOP_REACHED] = g_signal_new ("top-reached",
+	                                      G_TYPE_FROM_CLASS (klass),
+	                                      G_SIGNAL_RUN_LAST,
+	                                      G_STRUCT_OFFSET (PchatTextViewChatClass, top_reached),
+	                                      NULL, NULL,
+	                                      g_cclosure_marshal_VOID__VOID,
+	                                      G_TYPE_NONE, 0);
 }
 
 static void
@@ -458,13 +560,15 @@ pchat_textview_chat_init (PchatTextViewChat *chat)
 	                  G_CALLBACK (pchat_textview_chat_motion_notify), NULL);
 	g_signal_connect (chat, "leave-notify-event",
 	                  G_CALLBACK (pchat_textview_chat_leave_notify), NULL);
+	g_signal_connect (chat, "scroll-event",
+	                  G_CALLBACK (pchat_textview_chat_scroll_event), NULL);
 	
 	/* Connect realize handler to apply font when widget becomes visible */
 	g_signal_connect (chat, "realize",
 	                  G_CALLBACK (pchat_textview_chat_realize), NULL);
 	
 	/* Enable motion events */
-	gtk_widget_add_events (GTK_WIDGET (chat), GDK_POINTER_MOTION_MASK | GDK_LEAVE_NOTIFY_MASK);
+	gtk_widget_add_events (GTK_WIDGET (chat), GDK_POINTER_MOTION_MASK | GDK_LEAVE_NOTIFY_MASK | GDK_SCROLL_MASK);
 }
 
 GtkWidget *
@@ -475,17 +579,188 @@ pchat_textview_chat_new (void)
 
 /* Buffer management functions */
 
+/* The widget a buffer takes its tags from; buffers move between widgets
+ * when tabs are detached, and may outlive the one they were created for */
+static void
+pchat_chat_buffer_set_chat (PchatChatBuffer *buf, PchatTextViewChat *chat)
+{
+	if (buf->chat == chat)
+		return;
+	
+	if (buf->chat)
+		g_object_remove_weak_pointer (G_OBJECT (buf->chat), (gpointer *)&buf->chat);
+	buf->chat = chat;
+	if (chat)
+		g_object_add_weak_pointer (G_OBJECT (chat), (gpointer *)&buf->chat);
+}
+
+static void
+pchat_chat_buffer_clear_lines (PchatChatBuffer *buf)
+{
+	PchatRawLine *line;
+	
+	while ((line = g_queue_pop_head (&buf->lines)))
+		g_free (line);
+	buf->lines_released = 0;
+}
+
+static void
+pchat_chat_buffer_queue_line (PchatChatBuffer *buf, const gchar *text, gsize len,
+                              gboolean prepend)
+{
+	PchatRawLine *line;
+	
+	line = g_malloc (G_STRUCT_OFFSET (PchatRawLine, text) + len + 1);
+	line->len = len;
+	memcpy (line->text, text, len);
+	line->text[len] = 0;
+	
+	if (prepend)
+		g_queue_push_head (&buf->lines, line);
+	else
+		g_queue_push_tail (&buf->lines, line);
+}
+
+/* Turn the text between start and end back into IRC formatting codes,
+ * as pchat_textview_chat_insert_with_formatting would have parsed them */
+static void
+pchat_chat_buffer_serialize (PchatTextViewChatPrivate *priv, GtkTextIter *start,
+                             GtkTextIter *end, GString *out)
+{
+	GtkTextIter iter = *start, next;
+	gint fg_color = -1, bg_color = -1, fg, bg, i;
+	gboolean bold = FALSE, italic = FALSE, underline = FALSE, b, it, u;
+	gchar *text;
+	
+	while (gtk_text_iter_compare (&iter, end) < 0)
+	{
+		next = iter;
+		gtk_text_iter_forward_to_tag_toggle (&next, NULL);
+		if (gtk_text_iter_compare (&next, end) > 0)
+			next = *end;
+		
+		b = gtk_text_iter_has_tag (&iter, priv->bold_tag);
+		it = gtk_text_iter_has_tag (&iter, priv->italic_tag);
+		u = gtk_text_iter_has_tag (&iter, priv->underline_tag);
+		fg = bg = -1;
+		for (i = 0; i < 16; i++)
+		{
+			if (gtk_text_iter_has_tag (&iter, priv->fg_color_tags[i]))
+				fg = i;
+			if (gtk_text_iter_has_tag (&iter, priv->bg_color_tags[i]))
+				bg = i;
+		}
+		
+		if (b != bold || it != italic || u != underline || fg != fg_color || bg != bg_color)
+		{
+			if (bold || italic || underline || fg_color >= 0 || bg_color >= 0)
+				g_string_append_c (out, IRC_RESET);
+			if (fg >= 0)
+			{
+				g_string_append_printf (out, "%c%02d", IRC_COLOR, fg);
+				if (bg >= 0)
+					g_string_append_printf (out, ",%02d", bg);
+				/* Keep a leading ",5" in the text from reading as a background */
+				else if (!b && !it && !u && gtk_text_iter_get_char (&iter) == ',')
+					g_string_append (out, "\002\002");
+			}
+			if (b)
+				g_string_append_c (out, IRC_BOLD);
+			if (it)
+				g_string_append_c (out, IRC_ITALIC);
+			if (u)
+				g_string_append_c (out, IRC_UNDERLINE);
+			
+			bold = b;
+			italic = it;
+			underline = u;
+			fg_color = fg;
+			bg_color = bg;
+		}
+		
+		text = gtk_text_iter_get_text (&iter, &next);
+		g_string_append (out, text);
+		g_free (text);
+		
+		iter = next;
+	}
+}
+
+/* Drop the GtkTextBuffer of a buffer that has been hidden for a while,
+ * its lines go back into the raw queue and it is rebuilt from there
+ * when shown again */
+static gboolean
+pchat_chat_buffer_release_cb (gpointer user_data)
+{
+	PchatChatBuffer *buf = user_data;
+	GtkTextIter start, end;
+	GString *text;
+	
+	buf->release_timer = 0;
+	
+	if (!buf->buffer || !buf->chat)
+		return G_SOURCE_REMOVE;
+	if (buf->chat->priv->current_buffer == buf)
+		return G_SOURCE_REMOVE;
+	
+	/* All of it, including scrollback paged in above the last max_lines */
+	text = g_string_new (NULL);
+	gtk_text_buffer_get_start_iter (buf->buffer, &start);
+	while (!gtk_text_iter_is_end (&start))
+	{
+		end = start;
+		gtk_text_iter_forward_line (&end);
+		
+		/* The marker line isn't part of the text */
+		if (!gtk_text_iter_has_tag (&start, buf->chat->priv->marker_tag))
+		{
+			pchat_chat_buffer_serialize (buf->chat->priv, &start, &end, text);
+			pchat_chat_buffer_queue_line (buf, text->str, text->len, FALSE);
+			g_string_truncate (text, 0);
+		}
+		start = end;
+	}
+	g_string_free (text, TRUE);
+	buf->lines_released = buf->lines.length;
+	
+	g_object_unref (buf->buffer);
+	buf->buffer = NULL;
+	buf->end_mark = NULL;
+	buf->marker_mark = NULL;
+	buf->show_marker = FALSE;
+	
+	return G_SOURCE_REMOVE;
+}
+
+/* Start the clock on a buffer that is built but not shown */
+static void
+pchat_chat_buffer_release_later (PchatChatBuffer *buf)
+{
+	PchatTextViewChat *chat = buf->chat;
+	
+	if (!chat || !buf->buffer || buf->release_timer)
+		return;
+	if (chat->priv->buffer_release <= 0 || chat->priv->current_buffer == buf)
+		return;
+	
+	buf->release_timer = g_timeout_add_seconds (chat->priv->buffer_release,
+	                                            pchat_chat_buffer_release_cb, buf);
+}
+
 PchatChatBuffer *
 pchat_chat_buffer_new (PchatTextViewChat *chat)
 {
 	PchatChatBuffer *buf;
-	GtkTextIter iter;
-	PchatTextViewChatPrivate *priv = chat->priv;
 	
 	buf = g_new0 (PchatChatBuffer, 1);
 	
-	/* Use shared tag table for all buffers */
-	buf->buffer = gtk_text_buffer_new (priv->tag_table);
+	/* The GtkTextBuffer is only created once the buffer is shown, until
+	 * then lines are just queued (see pchat_chat_buffer_ensure) */
+	pchat_chat_buffer_set_chat (buf, chat);
+	g_queue_init (&buf->lines);
+	buf->lines_released = 0;
+	buf->buffer = NULL;
+	buf->end_mark = NULL;
 	buf->line_count = 0;
 	buf->indent = 0;
 	buf->marker_seen = FALSE;
@@ -497,10 +772,6 @@ pchat_chat_buffer_new (PchatTextViewChat *chat)
 	buf->search_nee = NULL;
 	buf->search_lnee = 0;
 	
-	/* Create end mark */
-	gtk_text_buffer_get_end_iter (buf->buffer, &iter);
-	buf->end_mark = gtk_text_buffer_create_mark (buf->buffer, "end", &iter, FALSE);
-	
 	return buf;
 }
 
@@ -515,6 +786,15 @@ pchat_chat_buffer_free (PchatChatBuffer *buf)
 	g_free (buf->search_text);
 	g_free (buf->search_nee);
 	
+	if (buf->release_timer)
+		g_source_remove (buf->release_timer);
+	pchat_chat_buffer_clear_lines (buf);
+	
+	/* Don't leave the widget pointing at freed memory */
+	if (buf->chat && buf->chat->priv->current_buffer == buf)
+		buf->chat->priv->current_buffer = NULL;
+	pchat_chat_buffer_set_chat (buf, NULL);
+	
 	/* The buffer should already be detached from any widget before freeing.
 	 * We just need to release our reference. */
 	if (buf->buffer)
@@ -527,11 +807,26 @@ void
 pchat_chat_buffer_show (PchatTextViewChat *chat, PchatChatBuffer *buf)
 {
 	PchatTextViewChatPrivate *priv = chat->priv;
+	PchatChatBuffer *hidden;
 	
 	if (!buf)
 		return;
 	
+	if (buf->release_timer)
+	{
+		g_source_remove (buf->release_timer);
+		buf->release_timer = 0;
+	}
+	
+	hidden = priv->current_buffer;
 	priv->current_buffer = buf;
+	pchat_chat_buffer_set_chat (buf, chat);
+	pchat_chat_buffer_ensure (buf);
+	
+	/* Start the clock on the buffer being hidden */
+	if (hidden && hidden != buf)
+		pchat_chat_buffer_release_later (hidden);
+	
 	gtk_text_view_set_buffer (GTK_TEXT_VIEW (chat), buf->buffer);
 	
 	/* Scroll to end using idle callback to ensure proper layout */
@@ -559,6 +854,11 @@ pchat_chat_buffer_set_marker (PchatChatBuffer *buf, PchatTextViewChat *chat)
 	if (!buf)
 		return;
 	
+	pchat_chat_buffer_set_chat (buf, chat);
+	pchat_chat_buffer_ensure (buf);
+	if (!buf->buffer)
+		return;
+	
 	/* Remove old marker if present */
 	if (buf->marker_mark)
 	{
@@ -679,20 +979,19 @@ flush_text_with_formatting (GtkTextBuffer *buffer, GtkTextIter *iter, GString *t
 	g_string_truncate (text, 0);
 }
 
-/* Parse IRC color codes and apply formatting */
+/* Parse IRC color codes and insert formatted text at iter */
 static void
-pchat_textview_chat_append_with_formatting (PchatTextViewChat *chat, GtkTextBuffer *buffer, const gchar *text, gsize len)
+pchat_textview_chat_insert_with_formatting (PchatTextViewChat *chat, GtkTextBuffer *buffer,
+                                             GtkTextIter *insert_iter, const gchar *text, gsize len)
 {
 	PchatTextViewChatPrivate *priv = chat->priv;
-	GtkTextIter iter;
+	GtkTextIter iter = *insert_iter;
 	const gchar *p = text;
 	const gchar *end = text + len;
 	GString *current_text = g_string_new (NULL);
 	gint fg_color = -1, bg_color = -1;
 	gboolean bold = FALSE, italic = FALSE, underline = FALSE;
 	
-	gtk_text_buffer_get_end_iter (buffer, &iter);
-	
 	while (p < end)
 	{
 		if (*p == IRC_BOLD)
@@ -776,6 +1075,91 @@ pchat_textview_chat_append_with_formatting (PchatTextViewChat *chat, GtkTextBuff
 	g_string_free (current_text, TRUE);
 }
 
+static void
+pchat_textview_chat_append_with_formatting (PchatTextViewChat *chat, GtkTextBuffer *buffer, const gchar *text, gsize len)
+{
+	GtkTextIter iter;
+	
+	gtk_text_buffer_get_end_iter (buffer, &iter);
+	pchat_textview_chat_insert_with_formatting (chat, buffer, &iter, text, len);
+}
+
+/* Build the GtkTextBuffer from the queued raw lines if it doesn't exist */
+void
+pchat_chat_buffer_ensure (PchatChatBuffer *buf)
+{
+	PchatTextViewChat *chat = buf->chat;
+	GtkTextIter iter;
+	GList *list;
+	
+	if (buf->buffer || !chat)
+		return;
+	
+	buf->buffer = gtk_text_buffer_new (chat->priv->tag_table);
+	
+	/* Create end mark */
+	gtk_text_buffer_get_end_iter (buf->buffer, &iter);
+	buf->end_mark = gtk_text_buffer_create_mark (buf->buffer, "end", &iter, FALSE);
+	
+	for (list = buf->lines.head; list; list = list->next)
+	{
+		PchatRawLine *line = list->data;
+		pchat_textview_chat_append_with_formatting (chat, buf->buffer, line->text, line->len);
+	}
+	
+	/* The GtkTextBuffer holds the text now, release_cb puts it back */
+	pchat_chat_buffer_clear_lines (buf);
+	
+	/* Built for lastlog, search or save while hidden */
+	pchat_chat_buffer_release_later (buf);
+}
+
+/* Add a line to the GtkTextBuffer or, if it hasn't been built, to the
+ * raw queue */
+static void
+pchat_chat_buffer_add (PchatChatBuffer *buf, PchatTextViewChat *chat,
+                       const gchar *text, gsize len, gboolean prepend)
+{
+	GtkTextIter iter;
+	guint max_lines;
+	
+	if (!buf->buffer && !buf->chat)
+		pchat_chat_buffer_set_chat (buf, chat);
+	
+	if (!buf->buffer)
+	{
+		/* The queue is a ring of the last max_lines lines, or of what the
+		 * buffer held when it was dropped if that was more */
+		max_lines = 0;
+		if (chat->priv->max_lines > 0)
+			max_lines = MAX ((guint)chat->priv->max_lines, buf->lines_released);
+		
+		if (prepend)
+		{
+			/* Older than anything in a full ring */
+			if (max_lines > 0 && buf->lines.length >= max_lines)
+				return;
+			pchat_chat_buffer_queue_line (buf, text, len, TRUE);
+		}
+		else
+		{
+			pchat_chat_buffer_queue_line (buf, text, len, FALSE);
+			if (max_lines > 0)
+			{
+				while (buf->lines.length > max_lines)
+					g_free (g_queue_pop_head (&buf->lines));
+			}
+		}
+		return;
+	}
+	
+	if (prepend)
+		gtk_text_buffer_get_start_iter (buf->buffer, &iter);
+	else
+		gtk_text_buffer_get_end_iter (buf->buffer, &iter);
+	pchat_textview_chat_insert_with_formatting (chat, buf->buffer, &iter, text, len);
+}
+
 void
 pchat_textview_chat_append (PchatTextViewChat *chat, const gchar *text, gsize len)
 {
@@ -795,7 +1179,7 @@ pchat_textview_chat_append (PchatTextViewChat *chat, const gchar *text, gsize le
 	/* Check if we're at bottom BEFORE appending text */
 	was_at_bottom = is_scrolled_to_bottom (GTK_TEXT_VIEW (chat));
 	
-	pchat_textview_chat_append_with_formatting (chat, buf->buffer, text, len);
+	pchat_chat_buffer_add (buf, chat, text, len, FALSE);
 	buf->line_count++;
 	
 	/* Auto-scroll to bottom using idle callback to ensure layout is complete */
@@ -827,7 +1211,7 @@ pchat_chat_buffer_append (PchatChatBuffer *buf, PchatTextViewChat *chat,
 	if (is_current_buffer)
 		was_at_bottom = is_scrolled_to_bottom (GTK_TEXT_VIEW (chat));
 	
-	pchat_textview_chat_append_with_formatting (chat, buf->buffer, text, len);
+	pchat_chat_buffer_add (buf, chat, text, len, FALSE);
 	buf->line_count++;
 	
 	/* Auto-scroll if this is the current buffer and we were at bottom */
@@ -955,6 +1339,86 @@ pchat_chat_buffer_append_indent (PchatChatBuffer *buf, PchatTextViewChat *chat,
 	g_string_free (full_text, TRUE);
 }
 
+#define PREPEND_ANCHOR "prepend-anchor"
+
+/* Put the view back on the text that was visible before the prepends */
+static gboolean
+prepend_anchor_idle (gpointer user_data)
+{
+	GtkTextView *view = GTK_TEXT_VIEW (user_data);
+	GtkTextBuffer *buffer;
+	GtkTextMark *anchor;
+	
+	buffer = gtk_text_view_get_buffer (view);
+	anchor = buffer ? gtk_text_buffer_get_mark (buffer, PREPEND_ANCHOR) : NULL;
+	if (anchor)
+	{
+		gtk_text_view_scroll_to_mark (view, anchor, 0.0, TRUE, 0.0, 0.0);
+		gtk_text_buffer_delete_mark (buffer, anchor);
+	}
+	
+	return G_SOURCE_REMOVE;
+}
+
+/* Insert a line above everything in the buffer, used for paging in older
+ * scrollback. If the buffer is shown, the view stays on the same text. */
+void
+pchat_chat_buffer_prepend_indent (PchatChatBuffer *buf, PchatTextViewChat *chat,
+                                   const gchar *left_text, gsize left_len,
+                                   const gchar *right_text, gsize right_len,
+                                   time_t stamp)
+{
+	GtkTextView *view;
+	GtkTextIter iter;
+	GdkRectangle rect;
+	GString *full_text;
+	
+	if (!buf || !chat)
+		return;
+	
+	full_text = g_string_new (NULL);
+	
+	/* Add timestamp if enabled */
+	if (chat->priv->show_timestamps && stamp != 0)
+	{
+		struct tm *tm_ptr = localtime (&stamp);
+		gchar time_str[64];
+		strftime (time_str, sizeof (time_str), "%H:%M:%S ", tm_ptr);
+		g_string_append (full_text, time_str);
+	}
+	
+	/* Add left text */
+	if (left_text && left_len > 0)
+	{
+		g_string_append_len (full_text, left_text, left_len);
+		if (chat->priv->indent)
+			g_string_append (full_text, " ");
+	}
+	
+	/* Add right text */
+	if (right_text && right_len > 0)
+		g_string_append_len (full_text, right_text, right_len);
+	
+	g_string_append_c (full_text, '\n');
+	
+	/* Remember the first visible line once per batch of prepends; right
+	 * gravity keeps the mark after the new text even at the very top */
+	if (buf == chat->priv->current_buffer && buf->buffer &&
+	    !gtk_text_buffer_get_mark (buf->buffer, PREPEND_ANCHOR))
+	{
+		view = GTK_TEXT_VIEW (chat);
+		gtk_text_view_get_visible_rect (view, &rect);
+		gtk_text_view_get_line_at_y (view, &iter, rect.y, NULL);
+		gtk_text_buffer_create_mark (buf->buffer, PREPEND_ANCHOR, &iter, FALSE);
+		g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, prepend_anchor_idle,
+		                 g_object_ref (chat), g_object_unref);
+	}
+	
+	pchat_chat_buffer_add (buf, chat, full_text->str, full_text->len, TRUE);
+	buf->line_count++;
+	g_string_free (full_text, TRUE);
+}
+
 void
 pchat_textview_chat_clear (PchatTextViewChat *chat, gint lines)
 {
@@ -970,7 +1434,9 @@ pchat_textview_chat_clear (PchatTextViewChat *chat, gint lines)
 	/* If lines == 0, clear everything */
 	if (lines == 0)
 	{
-		gtk_text_buffer_set_text (buf->buffer, "", 0);
+		pchat_chat_buffer_clear_lines (buf);
+		if (buf->buffer)
+			gtk_text_buffer_set_text (buf->buffer, "", 0);
 		buf->line_count = 0;
 	}
 	else
@@ -988,7 +1454,9 @@ pchat_chat_buffer_clear (PchatChatBuffer *buf, gint lines)
 	/* If lines == 0, clear everything */
 	if (lines == 0)
 	{
-		gtk_text_buffer_set_text (buf->buffer, "", 0);
+		pchat_chat_buffer_clear_lines (buf);
+		if (buf->buffer)
+			gtk_text_buffer_set_text (buf->buffer, "", 0);
 		buf->line_count = 0;
 	}
 	else
@@ -1066,6 +1534,13 @@ pchat_textview_chat_set_max_lines (PchatTextViewChat *chat, gint max_lines)
 	chat->priv->max_lines = max_lines;
 }
 
+void
+pchat_textview_chat_set_buffer_release (PchatTextViewChat *chat, gint seconds)
+{
+	g_return_if_fail (PCHAT_IS_TEXTVIEW_CHAT (chat));
+	chat->priv->buffer_release = seconds;
+}
+
 void
 pchat_textview_chat_set_show_timestamps (PchatTextViewChat *chat, gboolean show)
 {
@@ -1198,6 +1673,10 @@ pchat_textview_chat_search (PchatTextViewChat *chat, const gchar *text,
 	if (!buf)
 		return FALSE;
 	
+	pchat_chat_buffer_ensure (buf);
+	if (!buf->buffer)
+		return FALSE;
+	
 	/* Set search flags */
 	if (!(flags & PCHAT_SEARCH_CASE_MATCH))
 		search_flags |= GTK_TEXT_SEARCH_CASE_INSENSITIVE;
@@ -1270,6 +1749,10 @@ pchat_textview_chat_save (PchatTextViewChat *chat, int fd)
 	if (!buf)
 		return;
 	
+	pchat_chat_buffer_ensure (buf);
+	if (!buf->buffer)
+		return;
+	
 	/* Get all text from buffer */
 	gtk_text_buffer_get_bounds (buf->buffer, &start, &end);
 	text = gtk_text_buffer_get_text (buf->buffer, &start, &end, FALSE);
@@ -1290,6 +1773,10 @@ pchat_chat_buffer_save (PchatChatBuffer *buf, int fd)
 	g_return_if_fail (buf != NULL);
 	g_return_if_fail (fd >= 0);
 	
+	pchat_chat_buffer_ensure (buf);
+	if (!buf->buffer)
+		return;
+	
 	/* Get all text from buffer */
 	gtk_text_buffer_get_bounds (buf->buffer, &start, &end);
 	text = gtk_text_buffer_get_text (buf->buffer, &start, &end, FALSE);
@@ -1327,6 +1814,10 @@ pchat_textview_chat_foreach (PchatTextViewChat *chat,
 	if (!buf)
 		return;
 	
+	pchat_chat_buffer_ensure (buf);
+	if (!buf->buffer)
+		return;
+	
 	gtk_text_buffer_get_bounds (buf->buffer, &start, &end);
 	line_count = gtk_text_buffer_get_line_count (buf->buffer);
 	
@@ -1460,6 +1951,11 @@ pchat_chat_buffer_lastlog (PchatChatBuffer *output, PchatChatBuffer *search_area
 	if (!search_area->search_re && !search_area->search_nee)
 		return 0;
 	
+	/* Searching needs the text, build it if the buffer was released */
+	pchat_chat_buffer_ensure (search_area);
+	if (!search_area->buffer)
+		return 0;
+	
 	line_count = gtk_text_buffer_get_line_count (search_area->buffer);
 	
 	/* Iterate through all lines in search_area */
@@ -1479,10 +1975,9 @@ pchat_chat_buffer_lastlog (PchatChatBuffer *output, PchatChatBuffer *search_area
 			if (pchat_chat_buffer_line_matches (search_area, line_text))
 			{
 				/* Copy the line to output buffer */
-				GtkTextIter output_end;
-				gtk_text_buffer_get_end_iter (output->buffer, &output_end);
-				gtk_text_buffer_insert (output->buffer, &output_end, line_text, -1);
-				gtk_text_buffer_insert (output->buffer, &output_end, "\n", 1);
+				gchar *out_line = g_strconcat (line_text, "\n", NULL);
+				pchat_chat_buffer_add (output, chat, out_line, strlen (out_line), FALSE);
+				g_free (out_line);
 				
 				output->line_count++;
 				matches++;
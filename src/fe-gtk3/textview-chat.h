@@ -39,7 +39,7 @@ typedef struct _PchatChatBuffer         PchatChatBuffer;
 /* Chat buffer - similar to xtext_buffer */
 struct _PchatChatBuffer
 {
-	GtkTextBuffer *buffer;
+	GtkTextBuffer *buffer;      /* NULL until first shown or after release */
 	GtkTextMark *end_mark;
 	GtkTextMark *marker_mark;  /* Marker line position */
 	gint line_count;
@@ -53,6 +53,12 @@ struct _PchatChatBuffer
 	gchar *search_text;         /* Original search string */
 	gchar *search_nee;          /* Casefolded search string */
 	gint search_lnee;           /* Length of search_nee */
+	
+	/* Deferred/released GtkTextBuffer */
+	PchatTextViewChat *chat;    /* Widget whose tags are used (weak) */
+	GQueue lines;               /* Raw lines while buffer is NULL, see pchat_chat_buffer_ensure */
+	guint lines_released;       /* Lines the buffer held when it was dropped */
+	guint release_timer;        /* Frees buffer once hidden long enough */
 };
 
 struct _PchatTextViewChat
@@ -67,6 +73,7 @@ struct _PchatTextViewChatClass
 	
 	/* Signals */
 	void (*word_clicked) (PchatTextViewChat *chat, const gchar *word, GdkEventButton *event);
+	void (*top_reached) (PchatTextViewChat *chat);  /* Scrolled to the top, wants older text */
 };
 
 GType pchat_textview_chat_get_type (void) G_GNUC_CONST;
@@ -79,6 +86,7 @@ PchatChatBuffer *pchat_chat_buffer_new (PchatTextViewChat *chat);
 void pchat_chat_buffer_free (PchatChatBuffer *buf);
 void pchat_chat_buffer_show (PchatTextViewChat *chat, PchatChatBuffer *buf);
 PchatChatBuffer *pchat_textview_chat_get_buffer (PchatTextViewChat *chat);
+void pchat_chat_buffer_ensure (PchatChatBuffer *buf);
 
 /* Core text operations */
 
@@ -89,6 +97,10 @@ void pchat_chat_buffer_append_indent (PchatChatBuffer *buf, PchatTextViewChat *c
                                        const gchar *left_text, gsize left_len,
                                        const gchar *right_text, gsize right_len,
                                        time_t stamp);
+void pchat_chat_buffer_prepend_indent (PchatChatBuffer *buf, PchatTextViewChat *chat,
+                                        const gchar *left_text, gsize left_len,
+                                        const gchar *right_text, gsize right_len,
+                                        time_t stamp);
 void pchat_chat_buffer_clear (PchatChatBuffer *buf, gint lines);
 
 /* Marker line support */
@@ -108,6 +120,7 @@ void pchat_textview_chat_clear (PchatTextViewChat *chat, gint lines);
 void pchat_textview_chat_set_palette (PchatTextViewChat *chat, GdkRGBA palette[], gint palette_size);
 void pchat_textview_chat_set_font (PchatTextViewChat *chat, const gchar *font_name);
 void pchat_textview_chat_set_max_lines (PchatTextViewChat *chat, gint max_lines);
+void pchat_textview_chat_set_buffer_release (PchatTextViewChat *chat, gint seconds);
 void pchat_textview_chat_set_max_auto_indent (PchatTextViewChat *chat, gint max_auto_indent);
 void pchat_textview_chat_set_show_timestamps (PchatTextViewChat *chat, gboolean show);
 void pchat_textview_chat_set_indent (PchatTextViewChat *chat, gboolean indent);
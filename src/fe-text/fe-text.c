@@ -36,13 +36,16 @@
 #include <sys/types.h>
 #include <ctype.h>
 #include <glib-object.h>
-#include "../common/xchat.h"
-#include "../common/xchatc.h"
+#include "../common/pchat.h"
+#include "../common/pchatc.h"
 #include "../common/cfgfiles.h"
 #include "../common/outbound.h"
 #include "../common/util.h"
 #include "../common/fe.h"
 #include "fe-text.h"
+#ifdef PCHAT_REPLAY
+#include "replay.h"
+#endif
 
 
 static int done = FALSE;		  /* finished ? */
@@ -141,8 +144,15 @@ timecat (char *buf, time_t stamp)
 	return strlen (stampbuf);
 }
 
+#ifdef PCHAT_REPLAY
+/* pchat-replay is headless, text is formatted but never rendered */
+void
+fe_print_text (struct session *sess, char *text, time_t stamp,
+			   gboolean no_activity)
+{
+}
 /* Windows doesn't handle ANSI codes in cmd.exe, need to not display them */
-#ifndef WIN32
+#elif !defined (WIN32)
 /*                       0  1  2  3  4  5  6  7   8   9   10 11  12  13  14 15 */
 static const short colconv[] = { 0, 7, 4, 2, 1, 3, 5, 11, 13, 12, 6, 16, 14, 15, 10, 7 };
 
@@ -422,6 +432,12 @@ fe_timeout_add (int interval, void *callback, void *userdata)
 	return g_timeout_add (interval, (GSourceFunc) callback, userdata);
 }
 
+int
+fe_timeout_add_seconds (int interval, void *callback, void *userdata)
+{
+	return g_timeout_add_seconds (interval, (GSourceFunc) callback, userdata);
+}
+
 void
 fe_input_remove (int tag)
 {
@@ -482,6 +498,10 @@ fe_args (int argc, char *argv[])
 	GError *error = NULL;
 	GOptionContext *context;
 
+#ifdef PCHAT_REPLAY
+	return replay_args (argc, argv);
+#endif
+
 #ifdef ENABLE_NLS
 	bindtextdomain (GETTEXT_PACKAGE, LOCALEDIR);
 	bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
@@ -520,7 +540,7 @@ fe_args (int argc, char *argv[])
 		}
 		free (exe);
 #else
-		printf ("%s\n", XCHATLIBDIR);
+		printf ("%s\n", PCHATLIBDIR);
 #endif
 		return 0;
 	}
@@ -560,6 +580,11 @@ fe_main (void)
 {
 	GIOChannel *keyboard_input;
 
+#ifdef PCHAT_REPLAY
+	replay_main ();
+	return;
+#endif
+
 	main_loop = g_main_loop_new(NULL, FALSE);
 
 	/* Keyboard Entry Setup */
@@ -625,7 +650,7 @@ fe_set_hilight (struct session *sess)
 {
 }
 void
-fe_set_tab_color (struct session *sess, int col)
+fe_set_tab_color (struct session *sess, tabcolor col)
 {
 }
 void
@@ -677,6 +702,10 @@ fe_text_clear (struct session *sess, int lines)
 {
 }
 void
+fe_prepend_text (struct session *sess, char *text, time_t stamp)
+{
+}
+void
 fe_progressbar_start (struct session *sess)
 {
 }
@@ -801,7 +830,7 @@ fe_userlist_hide (session * sess)
 {
 }
 void
-fe_lastlog (session *sess, session *lastlog_sess, char *sstr, gtk_xtext_search_flags flags)
+fe_lastlog (session *sess, session *lastlog_sess, char *sstr, int flags)
 {
 }
 void
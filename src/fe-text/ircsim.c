@@ -0,0 +1,753 @@
+/* PChat
+ * Copyright (C) 2025 Zach Bacon
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/* A small IRC server for load tests. It listens on a random loopback port,
+ * accepts one client and, once that client has registered, plays a fixed
+ * scenario at it. Everything is generated from constants, so two runs send
+ * exactly the same bytes.
+ *
+ * The server runs on the default main context next to the client, so the
+ * client only gets to read while the simulator isn't writing. To measure
+ * how far behind the client is, the simulator sends "PING :probe-N" at
+ * points in the script and times the PONG: the client answers in order,
+ * so the round trip covers every line queued before the probe. The final
+ * probe marks the end of the scenario. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gio/gio.h>
+#include "ircsim.h"
+
+#define SIM_NAME "ircsim.invalid"
+#define SIM_NAMES_LEN 400		/* bytes of nicks per 353 line */
+
+#define NAMES_USERS 50000
+#define SPLIT_USERS 5000
+#define SPLIT_ROUNDS 4
+#define FLOOD_USERS 100
+#define FLOOD_INTERVAL 10		/* ms between timer ticks */
+#define FLOOD_PER_TICK 10		/* 1000 messages a second */
+#define FLOOD_TICKS 500		/* five seconds */
+#define MODES_USERS 2000
+#define MODES_LINES 500
+#define TIME_USERS 100
+#define TIME_LINES 10000
+
+struct ircsim
+{
+	const ircsim_scenario *scenario;
+	GSocketListener *listener;
+	GCancellable *cancel;
+	guint16 port;
+
+	GSocket *socket;
+	GSource *in_source;
+	GSource *out_source;
+	GString *in;
+	GString *out;
+	gsize out_pos;
+
+	char *nick;
+	unsigned int got_user:1;
+	unsigned int cap_negotiating:1;
+	unsigned int registered:1;
+	unsigned int sasl_done:1;
+	unsigned int script_done:1;
+	unsigned int done:1;
+	char *error;
+
+	gint64 connected_at;
+	gint64 registered_at;
+	gint64 script_start;
+	gint64 script_end;
+	guint64 lines_sent;
+	guint64 bytes_sent;
+
+	GArray *probe_sent;		/* send time of each probe, 0 once answered */
+	GArray *probe_rtt;
+	guint probes_pending;
+
+	guint client_msgs;
+	gint64 first_msg;
+	gint64 last_msg;
+
+	guint timer;
+	int ticks;
+};
+
+static void sim_fail (ircsim *sim, const char *format, ...) G_GNUC_PRINTF (2, 3);
+static void sim_send (ircsim *sim, const char *format, ...) G_GNUC_PRINTF (2, 3);
+
+static const char *
+sim_nick (ircsim *sim)
+{
+	return sim->nick ? sim->nick : "*";
+}
+
+static void
+sim_fail (ircsim *sim, const char *format, ...)
+{
+	va_list args;
+
+	if (sim->error)
+		return;
+
+	va_start (args, format);
+	sim->error = g_strdup_vprintf (format, args);
+	va_end (args);
+	sim->done = TRUE;
+}
+
+static void
+sim_check_done (ircsim *sim)
+{
+	if (sim->done || !sim->script_done || sim->probes_pending)
+		return;
+	if (sim->client_msgs < (guint) sim->scenario->client_lines)
+		return;
+
+	if (sim->scenario->sasl && !sim->sasl_done)
+		sim_fail (sim, "client registered without authenticating");
+	/* the throttle lets a burst through, then about a line every two seconds */
+	if (sim->scenario->throttle && sim->client_msgs > 6 &&
+		 sim->last_msg - sim->first_msg < G_USEC_PER_SEC * 2)
+		sim_fail (sim, "%u lines arrived within two seconds with the throttle on", sim->client_msgs);
+	sim->done = TRUE;
+}
+
+static gboolean
+sim_out_cb (GSocket *socket, GIOCondition condition, gpointer data)
+{
+	ircsim *sim = data;
+	GError *error = NULL;
+	gssize n;
+
+	while (sim->out_pos < sim->out->len)
+	{
+		n = g_socket_send (socket, sim->out->str + sim->out_pos,
+								 sim->out->len - sim->out_pos, NULL, &error);
+		if (n < 0)
+		{
+			if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+			{
+				g_error_free (error);
+				return G_SOURCE_CONTINUE;
+			}
+			sim_fail (sim, "send failed: %s", error->message);
+			g_error_free (error);
+			break;
+		}
+		sim->out_pos += n;
+	}
+
+	g_string_truncate (sim->out, 0);
+	sim->out_pos = 0;
+	sim->out_source = NULL;
+	return G_SOURCE_REMOVE;
+}
+
+static void
+sim_send (ircsim *sim, const char *format, ...)
+{
+	va_list args;
+	gsize len = sim->out->len;
+
+	if (!sim->socket)
+		return;
+
+	va_start (args, format);
+	g_string_append_vprintf (sim->out, format, args);
+	va_end (args);
+	g_string_append_len (sim->out, "\r\n", 2);
+
+	sim->lines_sent++;
+	sim->bytes_sent += sim->out->len - len;
+
+	if (!sim->out_source)
+	{
+		sim->out_source = g_socket_create_source (sim->socket, G_IO_OUT, NULL);
+		g_source_set_callback (sim->out_source, (GSourceFunc) sim_out_cb, sim, NULL);
+		g_source_attach (sim->out_source, NULL);
+		g_source_unref (sim->out_source);
+	}
+}
+
+static void
+sim_probe (ircsim *sim)
+{
+	gint64 now = g_get_monotonic_time ();
+
+	sim_send (sim, "PING :probe-%u", sim->probe_sent->len);
+	g_array_append_val (sim->probe_sent, now);
+	sim->probes_pending++;
+}
+
+/* the last probe, the scenario is over once the client has answered it */
+static void
+sim_finish (ircsim *sim)
+{
+	sim_probe (sim);
+	sim->script_done = TRUE;
+}
+
+static void
+sim_pong (ircsim *sim, const char *text)
+{
+	const char *probe = strstr (text, "probe-");
+	gint64 *sent, now = g_get_monotonic_time (), rtt;
+	guint64 id;
+
+	if (!probe)
+		return;
+	id = g_ascii_strtoull (probe + 6, NULL, 10);
+	if (id >= sim->probe_sent->len)
+		return;
+
+	sent = &g_array_index (sim->probe_sent, gint64, id);
+	if (!*sent)
+		return;
+	rtt = now - *sent;
+	g_array_append_val (sim->probe_rtt, rtt);
+	*sent = 0;
+	sim->probes_pending--;
+
+	if (sim->script_done && !sim->probes_pending)
+		sim->script_end = now;
+	sim_check_done (sim);
+}
+
+/* the client joins chan with users others in it, every 50th an op and
+ * every 10th voiced */
+static void
+sim_join (ircsim *sim, const char *chan, int users)
+{
+	GString *names = g_string_new (NULL);
+	int i;
+
+	sim_send (sim, ":%s!user@client." SIM_NAME " JOIN %s", sim->nick, chan);
+	sim_send (sim, ":" SIM_NAME " 332 %s %s :ircsim %s, %d users", sim->nick, chan,
+				 sim->scenario->name, users);
+
+	g_string_append_printf (names, "@%s ", sim->nick);
+	for (i = 0; i < users; i++)
+	{
+		g_string_append_printf (names, "%su%05d ", i % 50 ? (i % 10 ? "" : "+") : "@", i);
+		if (names->len >= SIM_NAMES_LEN || i == users - 1)
+		{
+			sim_send (sim, ":" SIM_NAME " 353 %s = %s :%s", sim->nick, chan, names->str);
+			g_string_truncate (names, 0);
+		}
+	}
+	sim_send (sim, ":" SIM_NAME " 366 %s %s :End of /NAMES list.", sim->nick, chan);
+	g_string_free (names, TRUE);
+}
+
+static void
+scenario_names (ircsim *sim)
+{
+	sim_join (sim, "#names", NAMES_USERS);
+	sim_finish (sim);
+}
+
+/* half the channel splits off and comes back, ops and voices are
+ * restored four at a time as servers do after a netjoin */
+static void
+scenario_netsplit (ircsim *sim)
+{
+	GString *modes = g_string_new (NULL);
+	GString *targets = g_string_new (NULL);
+	int round, i;
+
+	sim_join (sim, "#split", SPLIT_USERS);
+	for (round = 0; round < SPLIT_ROUNDS; round++)
+	{
+		for (i = round % 2; i < SPLIT_USERS; i += 2)
+			sim_send (sim, ":u%05d!u%05d@host%05d." SIM_NAME " QUIT :hub." SIM_NAME " leaf." SIM_NAME,
+						 i, i, i);
+		sim_probe (sim);
+
+		for (i = round % 2; i < SPLIT_USERS; i += 2)
+			sim_send (sim, ":u%05d!u%05d@host%05d." SIM_NAME " JOIN #split", i, i, i);
+
+		for (i = round % 2; i < SPLIT_USERS; i += 2)
+		{
+			if (i % 10)
+				continue;
+			g_string_append_c (modes, i % 50 ? 'v' : 'o');
+			g_string_append_printf (targets, " u%05d", i);
+			if (modes->len == 4)
+			{
+				sim_send (sim, ":leaf." SIM_NAME " MODE #split +%s%s", modes->str, targets->str);
+				g_string_truncate (modes, 0);
+				g_string_truncate (targets, 0);
+			}
+		}
+		if (modes->len)
+		{
+			sim_send (sim, ":leaf." SIM_NAME " MODE #split +%s%s", modes->str, targets->str);
+			g_string_truncate (modes, 0);
+			g_string_truncate (targets, 0);
+		}
+		sim_probe (sim);
+	}
+
+	g_string_free (modes, TRUE);
+	g_string_free (targets, TRUE);
+	sim_finish (sim);
+}
+
+static gboolean
+flood_tick (gpointer data)
+{
+	ircsim *sim = data;
+	int i, user;
+
+	for (i = 0; i < FLOOD_PER_TICK; i++)
+	{
+		user = (sim->ticks * FLOOD_PER_TICK + i) % FLOOD_USERS;
+		sim_send (sim, ":u%05d!u%05d@host%05d." SIM_NAME " PRIVMSG #flood :message %d of the flood",
+					 user, user, user, sim->ticks * FLOOD_PER_TICK + i);
+	}
+	if (sim->ticks % 10 == 0)
+		sim_probe (sim);
+
+	if (++sim->ticks < FLOOD_TICKS)
+		return G_SOURCE_CONTINUE;
+
+	sim->timer = 0;
+	sim_finish (sim);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+scenario_flood (ircsim *sim)
+{
+	sim_join (sim, "#flood", FLOOD_USERS);
+	sim->timer = g_timeout_add (FLOOD_INTERVAL, flood_tick, sim);
+}
+
+static void
+scenario_modes (ircsim *sim)
+{
+	int i, u;
+
+	sim_join (sim, "#modes", MODES_USERS);
+	for (i = 0; i < MODES_LINES * 4; i++)
+	{
+		u = (i % MODES_LINES) * 4 % MODES_USERS;
+		switch (i / MODES_LINES)
+		{
+		case 0:
+		case 1:
+			sim_send (sim, ":" SIM_NAME " MODE #modes %cvvvv u%05d u%05d u%05d u%05d",
+						 i < MODES_LINES ? '+' : '-', u, u + 1, u + 2, u + 3);
+			break;
+		default:
+			sim_send (sim, ":u00000!u00000@host00000." SIM_NAME " MODE #modes %cb *!*@host%05d." SIM_NAME,
+						 i < MODES_LINES * 3 ? '+' : '-', u);
+		}
+		if (i % 250 == 249)
+			sim_probe (sim);
+	}
+	sim_finish (sim);
+}
+
+/* a bouncer playing back history, a second apart */
+static void
+scenario_servertime (ircsim *sim)
+{
+	GDateTime *start, *stamp;
+	char *iso;
+	int i, user;
+
+	sim_join (sim, "#time", TIME_USERS);
+	start = g_date_time_new_utc (2025, 1, 1, 0, 0, 0);
+	for (i = 0; i < TIME_LINES; i++)
+	{
+		user = i % TIME_USERS;
+		stamp = g_date_time_add_seconds (start, i);
+		iso = g_date_time_format (stamp, "%Y-%m-%dT%H:%M:%S.000Z");
+		sim_send (sim, "@time=%s :u%05d!u%05d@host%05d." SIM_NAME " PRIVMSG #time :history line %d",
+					 iso, user, user, user, i);
+		g_free (iso);
+		g_date_time_unref (stamp);
+		if (i % 1000 == 999)
+			sim_probe (sim);
+	}
+	g_date_time_unref (start);
+	sim_finish (sim);
+}
+
+/* the interesting part happened during registration */
+static void
+scenario_idle (ircsim *sim)
+{
+	sim_finish (sim);
+}
+
+const ircsim_scenario ircsim_scenarios[] =
+{
+	{"names", "join a channel of 50000 users", FALSE, FALSE, 0, scenario_names},
+	{"netsplit", "four netsplits and netjoins of half a 5000 user channel", FALSE, FALSE, 0, scenario_netsplit},
+	{"flood", "1000 channel messages a second for five seconds", FALSE, FALSE, 0, scenario_flood},
+	{"modes", "2000 voice and ban changes, four per line", FALSE, FALSE, 0, scenario_modes},
+	{"servertime", "10000 lines of server-time tagged history", FALSE, FALSE, 0, scenario_servertime},
+	{"sasl", "CAP negotiation and SASL PLAIN before registration", TRUE, FALSE, 0, scenario_idle},
+	{"throttle", "the client sends 10 lines with its flood throttle on", FALSE, TRUE, 10, scenario_idle},
+	{NULL}
+};
+
+const ircsim_scenario *
+ircsim_find_scenario (const char *name)
+{
+	int i;
+
+	for (i = 0; ircsim_scenarios[i].name; i++)
+	{
+		if (!g_ascii_strcasecmp (ircsim_scenarios[i].name, name))
+			return &ircsim_scenarios[i];
+	}
+	return NULL;
+}
+
+static void
+sim_register (ircsim *sim)
+{
+	const char *nick = sim->nick;
+
+	if (sim->registered || !nick || !sim->got_user || sim->cap_negotiating)
+		return;
+	sim->registered = TRUE;
+	sim->registered_at = g_get_monotonic_time ();
+
+	sim_send (sim, ":" SIM_NAME " 001 %s :Welcome to the IRCSim network %s", nick, nick);
+	sim_send (sim, ":" SIM_NAME " 002 %s :Your host is " SIM_NAME ", running ircsim", nick);
+	sim_send (sim, ":" SIM_NAME " 003 %s :This server was created for a load test", nick);
+	sim_send (sim, ":" SIM_NAME " 004 %s " SIM_NAME " ircsim iow bklmnopstv", nick);
+	sim_send (sim, ":" SIM_NAME " 005 %s CHANTYPES=# PREFIX=(ov)@+ CHANMODES=b,k,l,imnpst "
+				 "MODES=4 NETWORK=IRCSim CASEMAPPING=rfc1459 :are supported by this server", nick);
+	sim_send (sim, ":" SIM_NAME " 375 %s :- " SIM_NAME " Message of the Day -", nick);
+	sim_send (sim, ":" SIM_NAME " 372 %s :- scenario %s: %s", nick,
+				 sim->scenario->name, sim->scenario->description);
+	sim_send (sim, ":" SIM_NAME " 376 %s :End of /MOTD command.", nick);
+
+	sim->script_start = g_get_monotonic_time ();
+	sim->scenario->run (sim);
+}
+
+static void
+sim_authenticate (ircsim *sim, const char *arg)
+{
+	const char *nick = sim_nick (sim);
+
+	if (!g_ascii_strcasecmp (arg, "PLAIN"))
+		sim_send (sim, "AUTHENTICATE +");
+	else if (!strcmp (arg, "*"))
+		sim_send (sim, ":" SIM_NAME " 906 %s :SASL authentication aborted", nick);
+	else if (!strcmp (arg, "+") || strlen (arg) < 4)
+		sim_send (sim, ":" SIM_NAME " 904 %s :SASL authentication failed", nick);
+	else
+	{
+		sim_send (sim, ":" SIM_NAME " 900 %s %s!user@client." SIM_NAME " ircsim :You are now logged in as ircsim",
+					 nick, nick);
+		sim_send (sim, ":" SIM_NAME " 903 %s :SASL authentication successful", nick);
+		sim->sasl_done = TRUE;
+	}
+}
+
+/* one line from the client, without its line ending */
+static void
+sim_line (ircsim *sim, char *line)
+{
+	char **word;
+	char *text;
+	int words;
+
+	text = strstr (line, " :");
+	if (text)
+		*text++ = 0;
+	word = g_strsplit (line, " ", 0);
+	words = g_strv_length (word);
+	if (!words)
+		goto out;
+	if (text)
+	{
+		char **more = g_renew (char *, word, words + 2);
+
+		word = more;
+		word[words++] = g_strdup (text + 1);
+		word[words] = NULL;
+	}
+
+	if (!g_ascii_strcasecmp (word[0], "CAP") && words > 1)
+	{
+		if (!g_ascii_strcasecmp (word[1], "LS"))
+		{
+			sim->cap_negotiating = TRUE;
+			sim_send (sim, ":" SIM_NAME " CAP %s LS :multi-prefix server-time sasl=PLAIN", sim_nick (sim));
+		}
+		else if (!g_ascii_strcasecmp (word[1], "REQ") && words > 2)
+			sim_send (sim, ":" SIM_NAME " CAP %s ACK :%s", sim_nick (sim), word[2]);
+		else if (!g_ascii_strcasecmp (word[1], "END"))
+		{
+			sim->cap_negotiating = FALSE;
+			sim_register (sim);
+		}
+	}
+	else if (!g_ascii_strcasecmp (word[0], "AUTHENTICATE") && words > 1)
+		sim_authenticate (sim, word[1]);
+	else if (!g_ascii_strcasecmp (word[0], "NICK") && words > 1)
+	{
+		g_free (sim->nick);
+		sim->nick = g_strdup (word[1]);
+		sim_register (sim);
+	}
+	else if (!g_ascii_strcasecmp (word[0], "USER"))
+	{
+		sim->got_user = TRUE;
+		sim_register (sim);
+	}
+	else if (!g_ascii_strcasecmp (word[0], "PING"))
+		sim_send (sim, ":" SIM_NAME " PONG " SIM_NAME " :%s", words > 1 ? word[1] : "");
+	else if (!g_ascii_strcasecmp (word[0], "PONG"))
+		sim_pong (sim, words > 1 ? word[words - 1] : "");
+	else if (!g_ascii_strcasecmp (word[0], "MODE") && words == 2 && word[1][0] == '#')
+		sim_send (sim, ":" SIM_NAME " 324 %s %s +nt", sim_nick (sim), word[1]);
+	else if (!g_ascii_strcasecmp (word[0], "WHO") && words > 1)
+		sim_send (sim, ":" SIM_NAME " 315 %s %s :End of /WHO list.", sim_nick (sim), word[1]);
+	else if (!g_ascii_strcasecmp (word[0], "PRIVMSG"))
+	{
+		sim->last_msg = g_get_monotonic_time ();
+		if (!sim->client_msgs++)
+			sim->first_msg = sim->last_msg;
+		sim_check_done (sim);
+	}
+
+out:
+	g_strfreev (word);
+}
+
+static gboolean
+sim_in_cb (GSocket *socket, GIOCondition condition, gpointer data)
+{
+	ircsim *sim = data;
+	GError *error = NULL;
+	char buf[4096];
+	char *start, *end;
+	gssize n;
+
+	n = g_socket_receive (socket, buf, sizeof (buf), NULL, &error);
+	if (n < 0)
+	{
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+		{
+			g_error_free (error);
+			return G_SOURCE_CONTINUE;
+		}
+		sim_fail (sim, "receive failed: %s", error->message);
+		g_error_free (error);
+		sim->in_source = NULL;
+		return G_SOURCE_REMOVE;
+	}
+	if (n == 0)
+	{
+		if (!sim->done)
+			sim_fail (sim, "client disconnected");
+		sim->in_source = NULL;
+		return G_SOURCE_REMOVE;
+	}
+
+	g_string_append_len (sim->in, buf, n);
+	start = sim->in->str;
+	while ((end = memchr (start, '\n', sim->in->str + sim->in->len - start)))
+	{
+		*end = 0;
+		if (end > start && end[-1] == '\r')
+			end[-1] = 0;
+		sim_line (sim, start);
+		start = end + 1;
+	}
+	g_string_erase (sim->in, 0, start - sim->in->str);
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+sim_accept_cb (GObject *source, GAsyncResult *result, gpointer data)
+{
+	ircsim *sim = data;
+	GError *error = NULL;
+	GSocket *socket;
+
+	socket = g_socket_listener_accept_socket_finish (G_SOCKET_LISTENER (source), result, NULL, &error);
+	if (!socket)
+	{
+		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			sim_fail (sim, "accept failed: %s", error->message);
+		g_error_free (error);
+		return;
+	}
+
+	/* one client per run */
+	sim->socket = socket;
+	sim->connected_at = g_get_monotonic_time ();
+	g_socket_set_blocking (socket, FALSE);
+	g_socket_listener_close (sim->listener);
+
+	sim->in_source = g_socket_create_source (socket, G_IO_IN | G_IO_HUP | G_IO_ERR, NULL);
+	g_source_set_callback (sim->in_source, (GSourceFunc) sim_in_cb, sim, NULL);
+	g_source_attach (sim->in_source, NULL);
+	g_source_unref (sim->in_source);
+}
+
+ircsim *
+ircsim_new (const ircsim_scenario *scenario, GError **error)
+{
+	ircsim *sim;
+	GInetAddress *loopback;
+	GSocketAddress *address, *bound = NULL;
+
+	sim = g_new0 (ircsim, 1);
+	sim->scenario = scenario;
+	sim->in = g_string_new (NULL);
+	sim->out = g_string_sized_new (64 * 1024);
+	sim->probe_sent = g_array_new (FALSE, FALSE, sizeof (gint64));
+	sim->probe_rtt = g_array_new (FALSE, FALSE, sizeof (gint64));
+	sim->cancel = g_cancellable_new ();
+	sim->listener = g_socket_listener_new ();
+
+	loopback = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+	address = g_inet_socket_address_new (loopback, 0);
+	g_object_unref (loopback);
+
+	if (!g_socket_listener_add_address (sim->listener, address, G_SOCKET_TYPE_STREAM,
+													G_SOCKET_PROTOCOL_TCP, NULL, &bound, error))
+	{
+		g_object_unref (address);
+		ircsim_free (sim);
+		return NULL;
+	}
+	g_object_unref (address);
+
+	sim->port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (bound));
+	g_object_unref (bound);
+
+	g_socket_listener_accept_socket_async (sim->listener, sim->cancel, sim_accept_cb, sim);
+	return sim;
+}
+
+guint16
+ircsim_get_port (ircsim *sim)
+{
+	return sim->port;
+}
+
+gboolean
+ircsim_is_done (ircsim *sim)
+{
+	return sim->done;
+}
+
+const char *
+ircsim_get_error (ircsim *sim)
+{
+	return sim->error;
+}
+
+static int
+sim_cmp (const void *a, const void *b)
+{
+	gint64 x = *(const gint64 *) a;
+	gint64 y = *(const gint64 *) b;
+
+	return (x > y) - (x < y);
+}
+
+void
+ircsim_report (ircsim *sim)
+{
+	const ircsim_scenario *scenario = sim->scenario;
+	gint64 elapsed;
+	guint n;
+
+	printf ("scenario:     %s (%s)\n", scenario->name, scenario->description);
+	if (sim->registered)
+		printf ("registration: %.2f ms\n", (sim->registered_at - sim->connected_at) / 1e3);
+
+	if (sim->script_end)
+	{
+		elapsed = sim->script_end - sim->script_start;
+		printf ("server lines: %" G_GUINT64_FORMAT " (%" G_GUINT64_FORMAT " bytes)\n",
+				  sim->lines_sent, sim->bytes_sent);
+		printf ("elapsed:      %.3f s\n", elapsed / 1e6);
+		printf ("lines/sec:    %.0f\n", elapsed ? sim->lines_sent / (elapsed / 1e6) : 0.0);
+	}
+
+	n = sim->probe_rtt->len;
+	if (n)
+	{
+		gint64 *rtt = (gint64 *) sim->probe_rtt->data;
+
+		qsort (rtt, n, sizeof (gint64), sim_cmp);
+		printf ("probe rtt:    p50 %.2f ms, p99 %.2f ms, max %.2f ms (%u probes)\n",
+				  rtt[n / 2] / 1e3, rtt[n * 99 / 100] / 1e3, rtt[n - 1] / 1e3, n);
+	}
+
+	if (scenario->client_lines)
+	{
+		printf ("client lines: %u of %d", sim->client_msgs, scenario->client_lines);
+		if (sim->client_msgs > 1)
+			printf (" over %.2f s (%.2f lines/sec)",
+					  (sim->last_msg - sim->first_msg) / 1e6,
+					  (sim->client_msgs - 1) / ((sim->last_msg - sim->first_msg) / 1e6 + 1e-9));
+		printf ("\n");
+	}
+
+	if (sim->error)
+		printf ("FAILED:       %s\n", sim->error);
+}
+
+void
+ircsim_free (ircsim *sim)
+{
+	if (sim->timer)
+		g_source_remove (sim->timer);
+	if (sim->in_source)
+		g_source_destroy (sim->in_source);
+	if (sim->out_source)
+		g_source_destroy (sim->out_source);
+	if (sim->socket)
+	{
+		g_socket_close (sim->socket, NULL);
+		g_object_unref (sim->socket);
+	}
+	g_cancellable_cancel (sim->cancel);
+	g_object_unref (sim->cancel);
+	g_socket_listener_close (sim->listener);
+	g_object_unref (sim->listener);
+
+	g_string_free (sim->in, TRUE);
+	g_string_free (sim->out, TRUE);
+	g_array_free (sim->probe_sent, TRUE);
+	g_array_free (sim->probe_rtt, TRUE);
+	g_free (sim->nick);
+	g_free (sim->error);
+	g_free (sim);
+}
@@ -0,0 +1,46 @@
+/* PChat
+ * Copyright (C) 2025 Zach Bacon
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef PCHAT_IRCSIM_H
+#define PCHAT_IRCSIM_H
+
+#include <glib.h>
+
+typedef struct ircsim ircsim;
+
+typedef struct
+{
+	const char *name;
+	const char *description;
+	gboolean sasl;			/* client registers through SASL PLAIN */
+	gboolean throttle;		/* client sends with its flood throttle on */
+	int client_lines;		/* PRIVMSGs the client is asked to send to #throttle */
+	void (*run) (ircsim *sim);	/* started once the client is registered */
+} ircsim_scenario;
+
+extern const ircsim_scenario ircsim_scenarios[];
+
+const ircsim_scenario *ircsim_find_scenario (const char *name);
+ircsim *ircsim_new (const ircsim_scenario *scenario, GError **error);
+guint16 ircsim_get_port (ircsim *sim);
+gboolean ircsim_is_done (ircsim *sim);
+const char *ircsim_get_error (ircsim *sim);
+void ircsim_report (ircsim *sim);
+void ircsim_free (ircsim *sim);
+
+#endif
@@ -0,0 +1,562 @@
+/* PChat
+ * Copyright (C) 2025 Zach Bacon
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/* pchat-replay feeds a recorded IRC capture through server_inline() for
+ * a fake server and reports how quickly the core got through it. It is
+ * fe-text.c built with PCHAT_REPLAY, so nothing is rendered and no
+ * display is needed.
+ *
+ * A capture holds one server line per line of text. A "<< " prefix is
+ * removed and lines starting with ">> " are skipped, so a saved raw log
+ * can be replayed as is. Without a capture, --synthetic generates a
+ * busy channel instead.
+ *
+ * With --scenario the core instead makes a real connection to the load
+ * test server in ircsim.c, which reports on the run, and --emit times
+ * emitting text events by name through the plugin API. --load brings
+ * plugins and scripts into any of these, so their hooks are measured
+ * too. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+#include <glib.h>
+#include "../common/pchat.h"
+#include "../common/pchatc.h"
+#include "../common/server.h"
+#include "../common/util.h"
+#include "../common/outbound.h"
+#include "../common/servlist.h"
+#include "../common/pchat-plugin.h"
+#include "../common/plugin.h"
+#include "ircsim.h"
+#include "replay.h"
+
+#define REPLAY_USERS 500
+
+static char *arg_cfgdir = NULL;	/* already handled by main () */
+static char *arg_nick = NULL;
+static gint arg_loops = 1;
+static gint arg_synthetic = 0;
+static char *arg_scenario = NULL;
+static gint arg_timeout = 300;
+static gint arg_emit = 0;
+static char **arg_loads = NULL;
+static char **arg_captures = NULL;
+
+static const GOptionEntry replay_entries[] =
+{
+ {"cfgdir",	'd', 0, G_OPTION_ARG_STRING,	&arg_cfgdir, "Use a different config directory", "PATH"},
+ {"nick",	 0,  0, G_OPTION_ARG_STRING,	&arg_nick, "Nickname of the replayed connection", "NICK"},
+ {"loops",	'l', 0, G_OPTION_ARG_INT,	&arg_loops, "Replay the capture N times", "N"},
+ {"synthetic",	's', 0, G_OPTION_ARG_INT,	&arg_synthetic, "Replay N generated channel lines instead of a capture", "N"},
+ {"scenario",	 0,  0, G_OPTION_ARG_STRING,	&arg_scenario, "Connect to the load test server and run a scenario (\"list\" shows them)", "NAME"},
+ {"timeout",	 0,  0, G_OPTION_ARG_INT,	&arg_timeout, "Give up on a scenario after N seconds", "N"},
+ {"emit",	 0,  0, G_OPTION_ARG_INT,	&arg_emit, "Emit N \"Channel Message\" events by name through the plugin API", "N"},
+ {"load",	 0,  0, G_OPTION_ARG_FILENAME_ARRAY, &arg_loads, "Load a plugin or script before the run, may be repeated", "FILE"},
+ {G_OPTION_REMAINING, '\0', 0, G_OPTION_ARG_FILENAME_ARRAY, &arg_captures, NULL, "CAPTURE"},
+ {NULL}
+};
+
+#ifdef __GLIBC__
+/* Count allocations by wrapping glibc's allocator. Everything still ends
+ * up in the same heap, so free () and the aligned variants are left alone. */
+#define HAVE_ALLOC_COUNT
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+
+static guint64 alloc_count = 0;
+
+void *
+malloc (size_t size)
+{
+	__atomic_add_fetch (&alloc_count, 1, __ATOMIC_RELAXED);
+	return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+	__atomic_add_fetch (&alloc_count, 1, __ATOMIC_RELAXED);
+	return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+	__atomic_add_fetch (&alloc_count, 1, __ATOMIC_RELAXED);
+	return __libc_realloc (ptr, size);
+}
+
+static guint64
+replay_allocs (void)
+{
+	return __atomic_load_n (&alloc_count, __ATOMIC_RELAXED);
+}
+#endif
+
+/* nanoseconds from a monotonic clock */
+static guint64
+replay_now (void)
+{
+#ifdef WIN32
+	return (guint64) g_get_monotonic_time () * 1000;
+#else
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (guint64) ts.tv_sec * G_GUINT64_CONSTANT (1000000000) + ts.tv_nsec;
+#endif
+}
+
+static int
+replay_cmp (const void *a, const void *b)
+{
+	guint64 x = *(const guint64 *) a;
+	guint64 y = *(const guint64 *) b;
+
+	return (x > y) - (x < y);
+}
+
+static GPtrArray *
+replay_load (const char *filename)
+{
+	GPtrArray *lines;
+	GError *error = NULL;
+	char *contents, *line, *next;
+	size_t len;
+
+	if (!g_file_get_contents (filename, &contents, NULL, &error))
+	{
+		fprintf (stderr, "pchat-replay: %s\n", error->message);
+		g_error_free (error);
+		return NULL;
+	}
+
+	lines = g_ptr_array_new_with_free_func (g_free);
+	for (line = contents; *line; line = next)
+	{
+		next = strchr (line, '\n');
+		if (next)
+			*next++ = 0;
+		else
+			next = line + strlen (line);
+
+		len = strlen (line);
+		if (len && line[len - 1] == '\r')
+			line[len - 1] = 0;
+
+		if (strncmp (line, ">> ", 3) == 0)
+			continue;
+		if (strncmp (line, "<< ", 3) == 0)
+			line += 3;
+		if (*line)
+			g_ptr_array_add (lines, g_strdup (line));
+	}
+
+	g_free (contents);
+	return lines;
+}
+
+/* registration, a joined channel of REPLAY_USERS and then count lines of
+ * mostly chatter with some hilights, voice changes and part/join pairs */
+static GPtrArray *
+replay_generate (const char *nick, int count)
+{
+	GPtrArray *lines;
+	GString *names;
+	GRand *rand;
+	guint header;
+	int i, user;
+
+	lines = g_ptr_array_new_with_free_func (g_free);
+	rand = g_rand_new_with_seed (1);
+
+	g_ptr_array_add (lines, g_strdup_printf (":replay.invalid 001 %s :Welcome to the replay network %s", nick, nick));
+	g_ptr_array_add (lines, g_strdup_printf (":replay.invalid 376 %s :End of /MOTD command.", nick));
+	g_ptr_array_add (lines, g_strdup_printf (":%s!user@replay.invalid JOIN #replay", nick));
+
+	names = g_string_new (NULL);
+	for (i = 0; i < REPLAY_USERS; i++)
+	{
+		g_string_append_printf (names, "%suser%d ", i % 10 ? "" : "@", i);
+		if (i % 50 == 49 || i == REPLAY_USERS - 1)
+		{
+			g_ptr_array_add (lines, g_strdup_printf (":replay.invalid 353 %s = #replay :%s", nick, names->str));
+			g_string_truncate (names, 0);
+		}
+	}
+	g_string_free (names, TRUE);
+	g_ptr_array_add (lines, g_strdup_printf (":replay.invalid 366 %s #replay :End of /NAMES list.", nick));
+
+	header = lines->len;
+	while (lines->len < header + count)
+	{
+		user = g_rand_int_range (rand, 0, REPLAY_USERS);
+		switch (g_rand_int_range (rand, 0, 20))
+		{
+		case 0:
+			g_ptr_array_add (lines, g_strdup_printf (":user%d!u%d@host%d.replay.invalid PART #replay :brb", user, user, user));
+			g_ptr_array_add (lines, g_strdup_printf (":user%d!u%d@host%d.replay.invalid JOIN #replay", user, user, user));
+			break;
+		case 1:
+			g_ptr_array_add (lines, g_strdup_printf (":replay.invalid MODE #replay %cv user%d",
+																  g_rand_boolean (rand) ? '+' : '-', user));
+			break;
+		case 2:
+			g_ptr_array_add (lines, g_strdup_printf (":user%d!u%d@host%d.replay.invalid PRIVMSG #replay :%s: are you around?",
+																  user, user, user, nick));
+			break;
+		default:
+			g_ptr_array_add (lines, g_strdup_printf (":user%d!u%d@host%d.replay.invalid PRIVMSG #replay :line %u of some ordinary channel chatter",
+																  user, user, user, lines->len));
+		}
+	}
+
+	g_rand_free (rand);
+	return lines;
+}
+
+/* run whatever the core queued up (idle callbacks and such), but don't
+ * spin forever on a source that keeps itself alive */
+static void
+replay_drain (void)
+{
+	int i;
+
+	for (i = 0; i < 1000 && g_main_context_iteration (NULL, FALSE); i++)
+		;
+}
+
+int
+replay_args (int argc, char *argv[])
+{
+	GError *error = NULL;
+	GOptionContext *context;
+
+	context = g_option_context_new ("[CAPTURE]");
+	g_option_context_set_summary (context,
+		"Replays an IRC capture through the PChat core and reports lines/sec,\n"
+		"per-line latency and allocations. Use -d with an empty directory to\n"
+		"keep your own configuration out of the measurement.\n\n"
+		"--scenario runs one of the load tests against a local simulated\n"
+		"server instead and reports throughput, latency and memory.\n\n"
+		"--load adds a plugin's or script's hooks to the run; load a script\n"
+		"interface (python, lua) before its scripts.");
+	g_option_context_add_main_entries (context, replay_entries, NULL);
+	if (!g_option_context_parse (context, &argc, &argv, &error))
+	{
+		fprintf (stderr, "pchat-replay: %s\n", error->message);
+		g_error_free (error);
+		g_option_context_free (context);
+		return 1;
+	}
+	g_option_context_free (context);
+
+	if (arg_scenario)
+	{
+		int i;
+
+		if (!strcmp (arg_scenario, "list"))
+		{
+			for (i = 0; ircsim_scenarios[i].name; i++)
+				printf ("%-12s %s\n", ircsim_scenarios[i].name, ircsim_scenarios[i].description);
+			return 0;
+		}
+		if (!ircsim_find_scenario (arg_scenario))
+		{
+			fprintf (stderr, "pchat-replay: no scenario called %s, try --scenario=list\n", arg_scenario);
+			return 1;
+		}
+	}
+	else if (!arg_synthetic && !arg_emit && (!arg_captures || !arg_captures[0]))
+	{
+		fprintf (stderr, "pchat-replay: give a capture file, --synthetic=N, --scenario=NAME or --emit=N\n");
+		return 1;
+	}
+	if (arg_loops < 1)
+		arg_loops = 1;
+	if (!arg_nick)
+		arg_nick = g_strdup ("pchat");
+
+	/* no plugins but those from --load, no connecting anywhere and
+	 * nothing written to disk */
+	arg_skip_plugins = TRUE;
+	arg_dont_autoconnect = TRUE;
+	prefs.pchat_irc_logging = 0;
+	prefs.pchat_net_throttle = 0;
+
+	return -1;
+}
+
+/* resident set size in kilobytes, 0 where that's not known */
+static guint64
+replay_rss (void)
+{
+#ifdef __linux__
+	char *contents;
+	guint64 pages = 0;
+
+	if (g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+	{
+		sscanf (contents, "%*s %" G_GUINT64_FORMAT, &pages);
+		g_free (contents);
+	}
+	return pages * (sysconf (_SC_PAGESIZE) / 1024);
+#else
+	return 0;
+#endif
+}
+
+static gboolean
+replay_timeout_cb (gpointer data)
+{
+	*(gboolean *) data = TRUE;
+	return G_SOURCE_REMOVE;
+}
+
+/* connect the core to ircsim and run the main loop until the scenario
+ * is over; exits non-zero if it failed so ctest notices */
+static void
+replay_scenario (server *serv)
+{
+	const ircsim_scenario *scenario = ircsim_find_scenario (arg_scenario);
+	GError *error = NULL;
+	ircsim *sim;
+	gboolean timed_out = FALSE, failed;
+	guint64 rss_before, rss_after;
+	guint timer;
+	int sent = 0;
+	char buf[64];
+
+	sim = ircsim_new (scenario, &error);
+	if (!sim)
+	{
+		fprintf (stderr, "pchat-replay: %s\n", error->message);
+		g_error_free (error);
+		exit (1);
+	}
+
+	safe_strcpy (prefs.pchat_irc_nick1, arg_nick, sizeof (prefs.pchat_irc_nick1));
+	prefs.pchat_net_throttle = scenario->throttle;
+	if (scenario->sasl)
+	{
+		serv->loginmethod = LOGIN_SASL;
+		safe_strcpy (serv->password, "ircsim", sizeof (serv->password));
+	}
+	serv->use_ssl = FALSE;
+
+	rss_before = replay_rss ();
+	timer = g_timeout_add_seconds (arg_timeout, replay_timeout_cb, &timed_out);
+	serv->connect (serv, "127.0.0.1", ircsim_get_port (sim), FALSE);
+
+	while (!ircsim_is_done (sim) && !timed_out)
+	{
+		g_main_context_iteration (NULL, TRUE);
+
+		/* queued through the same path as typed text, so the throttle applies */
+		while (serv->end_of_motd && sent < scenario->client_lines)
+		{
+			g_snprintf (buf, sizeof (buf), "msg #throttle line %d", ++sent);
+			handle_command (serv->server_session, buf, FALSE);
+		}
+	}
+	rss_after = replay_rss ();
+	if (!timed_out)
+		g_source_remove (timer);
+
+	ircsim_report (sim);
+	if (rss_after)
+		printf ("rss:          %" G_GUINT64_FORMAT " kB (+%" G_GUINT64_FORMAT " kB)\n",
+				  rss_after, rss_after > rss_before ? rss_after - rss_before : 0);
+	if (timed_out)
+		printf ("FAILED:       timed out after %d s\n", arg_timeout);
+
+	failed = timed_out || ircsim_get_error (sim) != NULL;
+	ircsim_free (sim);
+	if (failed)
+		exit (1);
+}
+
+static pchat_plugin *emit_ph;
+
+static int
+replay_emit_init (pchat_plugin *plugin_handle, char **plugin_name,
+						char **plugin_desc, char **plugin_version, char *arg)
+{
+	emit_ph = plugin_handle;
+
+	*plugin_name = "replay-emit";
+	*plugin_desc = "pchat-replay --emit";
+	*plugin_version = "";
+
+	return 1;
+}
+
+/* what a script pays per re-emitted line, minus the script itself */
+static void
+replay_emit (session *sess)
+{
+	guint64 start, elapsed;
+	int i, emitted = 0;
+#ifdef HAVE_ALLOC_COUNT
+	guint64 allocs = replay_allocs ();
+#endif
+
+	plugin_add (sess, NULL, NULL, replay_emit_init, NULL, NULL, FALSE);
+	if (!emit_ph)
+		return;
+	pchat_set_context (emit_ph, sess);
+
+	start = replay_now ();
+	for (i = 0; i < arg_emit; i++)
+		emitted += pchat_emit_print (emit_ph, "Channel Message", "someone",
+											  "a line a script has rewritten", "@", NULL);
+	elapsed = replay_now () - start;
+#ifdef HAVE_ALLOC_COUNT
+	allocs = replay_allocs () - allocs;
+#endif
+
+	if (emitted != arg_emit)
+		fprintf (stderr, "pchat-replay: only %d of %d events were emitted\n", emitted, arg_emit);
+
+	printf ("events:      %d\n", arg_emit);
+	printf ("elapsed:     %.3f s\n", elapsed / 1e9);
+	printf ("events/sec:  %.0f\n", elapsed ? arg_emit / (elapsed / 1e9) : 0.0);
+	printf ("per event:   %.1f ns\n", (double) elapsed / arg_emit);
+#ifdef HAVE_ALLOC_COUNT
+	printf ("allocations: %" G_GUINT64_FORMAT " (%.1f per event)\n", allocs, (double) allocs / arg_emit);
+#else
+	printf ("allocations: n/a\n");
+#endif
+}
+
+void
+replay_main (void)
+{
+	GPtrArray *lines;
+	server *serv;
+	guint64 *latency, start, elapsed = 0, allocs = 0;
+	guint i, n, total;
+	int loop;
+	size_t len;
+
+	/* xchat_init () opened a server tab since autoconnect is off */
+	if (!current_sess)
+	{
+		fprintf (stderr, "pchat-replay: no session to replay into\n");
+		return;
+	}
+	serv = current_sess->server;
+
+	/* through /load, so script interfaces can pick up their files */
+	for (i = 0; arg_loads && arg_loads[i]; i++)
+	{
+		char *cmd = g_strdup_printf ("load \"%s\"", arg_loads[i]);
+
+		handle_command (current_sess, cmd, FALSE);
+		g_free (cmd);
+	}
+
+	if (arg_scenario)
+	{
+		replay_scenario (serv);
+		return;
+	}
+	if (arg_emit)
+	{
+		replay_emit (current_sess);
+		return;
+	}
+
+	if (arg_synthetic)
+		lines = replay_generate (arg_nick, arg_synthetic);
+	else
+		lines = replay_load (arg_captures[0]);
+	if (!lines)
+		return;
+	if (!lines->len)
+	{
+		fprintf (stderr, "pchat-replay: nothing to replay\n");
+		g_ptr_array_free (lines, TRUE);
+		return;
+	}
+
+	/* a registered connection that nothing is ever sent to; writes to
+	 * the -1 socket simply fail */
+	safe_strcpy (serv->servername, "replay.invalid", sizeof (serv->servername));
+	safe_strcpy (serv->nick, arg_nick, sizeof (serv->nick));
+	serv->connected = TRUE;
+	server_set_name (serv, serv->servername);
+	replay_drain ();
+
+	total = lines->len * arg_loops;
+	latency = g_new (guint64, total);
+
+	for (loop = 0, n = 0; loop < arg_loops; loop++)
+	{
+#ifdef HAVE_ALLOC_COUNT
+		guint64 allocs_before = replay_allocs ();
+#endif
+		start = replay_now ();
+		for (i = 0; i < lines->len; i++, n++)
+		{
+			guint64 line_start;
+
+			/* same buffer server_read () hands over */
+			len = strlen (lines->pdata[i]);
+			if (len >= sizeof (serv->linebuf))
+				len = sizeof (serv->linebuf) - 1;
+			memcpy (serv->linebuf, lines->pdata[i], len);
+			serv->linebuf[len] = 0;
+
+			line_start = replay_now ();
+			server_inline (serv, serv->linebuf, len);
+			latency[n] = replay_now () - line_start;
+		}
+		elapsed += replay_now () - start;
+#ifdef HAVE_ALLOC_COUNT
+		allocs += replay_allocs () - allocs_before;
+#endif
+		replay_drain ();
+	}
+
+	qsort (latency, total, sizeof (guint64), replay_cmp);
+
+	printf ("lines:       %u\n", total);
+	printf ("elapsed:     %.3f s\n", elapsed / 1e9);
+	printf ("lines/sec:   %.0f\n", elapsed ? total / (elapsed / 1e9) : 0.0);
+	printf ("latency p50: %.2f us\n", latency[total / 2] / 1e3);
+	printf ("latency p99: %.2f us\n", latency[(guint64) total * 99 / 100] / 1e3);
+	printf ("latency max: %.2f us\n", latency[total - 1] / 1e3);
+#ifdef HAVE_ALLOC_COUNT
+	printf ("allocations: %" G_GUINT64_FORMAT " (%.1f per line)\n", allocs, (double) allocs / total);
+#else
+	printf ("allocations: n/a\n");
+#endif
+
+	g_free (latency);
+	g_ptr_array_free (lines, TRUE);
+}